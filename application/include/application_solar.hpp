@@ -2,6 +2,10 @@
 #define APPLICATION_SOLAR_HPP
 
 #include "application.hpp"
+#include "asset_streamer.hpp"
+#include "draw_batch.hpp"
+#include "geometry_pool.hpp"
+#include "stream_buffer.hpp"
 #include "model.hpp"
 #include "structs.hpp"
 
@@ -20,8 +24,15 @@ class ApplicationSolar : public Application {
   void updateProjectionStars();
   // react to key input
   void keyCallback(int key, int scancode, int action, int mods);
+  // advance orbits by fixed timestep
+  void update(double timestep);
+  // transform, cull and sort bodies for next frame
+  void prepareFrame();
+  // frame preparation only accesses buffered state
+  inline bool concurrentUpdate() const { return true; };
+  // whether streamed assets are still outstanding
+  bool loading() const;
   // draw all objects
-  void upload_planet_transforms(struct planet pl) const;
   void render() const;
   void renderPlanets() const;
   void renderStars() const;
@@ -30,7 +41,6 @@ class ApplicationSolar : public Application {
 
  protected:
   void initializeShaderPrograms();
-  void initializeGeometry(model & model_);
   void initializePlanets();
   void initializeStars();
   void initializeSkydome();
@@ -39,11 +49,21 @@ class ApplicationSolar : public Application {
   void initializeScreenQuadGeometry();
   void updateView();
   void updateViewStars();
+  void publishCamera() const;
 
   // cpu representation of model
-  model_object m_obj_planet;
   model_object m_obj_star;
-  model_object m_obj_skydome;
+  // all indexed meshes share the buffers and vertex array of this pool
+  geometry_pool m_geometry;
+  // sphere drawn for the skydome, bodies use the level of detail matching their size
+  mesh_range m_sphere_mesh;
+  // ring of regions for data written every frame
+  mutable stream_buffer m_frame_data;
+  // planets and moon, submitted in one call where supported
+  mutable draw_batch m_body_batch;
+
+  // textures and models are loaded in the background, placeholders are drawn meanwhile
+  mutable asset_streamer m_assets;
 };
 
 #endif
\ No newline at end of file
@@ -3,9 +3,16 @@
 
 #include "utils.hpp"
 #include "shader_loader.hpp"
-#include "model_loader.hpp"
-#include "texture_loader.hpp"
 #include "pixel_data.hpp"
+#include "resolution_scaler.hpp"
+#include "culling.hpp"
+#include "memory_tracker.hpp"
+#include "triple_buffer.hpp"
+#include "vertex_layout.hpp"
+#include "draw_batch.hpp"
+#include "stream_buffer.hpp"
+#include "model_loader.hpp"
+#include "procedural_mesh.hpp"
 
 #include <glbinding/gl/gl.h>
 // use gl definitions from glbinding 
@@ -15,10 +22,13 @@ using namespace gl;
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
     // draw all objects
 
@@ -66,125 +76,452 @@ struct planet
   int order;
 };
 
-int number_of_stars;
+// interleaved sphere vertices, locations match simple.vert and skydome.vert
+typedef vertex_layout<vertex_attribute::position, vertex_attribute::normal, vertex_attribute::texcoord> sphere_layout;
+
+// star field is generated deterministically from seed on the gpu
+const GLsizei number_of_stars = 500000;
+const GLuint star_seed = 42u;
+const float star_min_distance = 20.0f;
+const float star_max_distance = 55.0f;
+// bounding sphere of the whole star field
+glm::fvec3 star_bounds_center{0.0f};
+float star_bounds_radius = 0.0f;
 std::vector<struct planet> planets;
-std::vector<struct texture_obj> planet_textures;
-std::vector<struct texture_obj> other_textures;
+// planet textures followed by the moon texture, one layer each,
+// so all bodies are drawn with a single texture binding
+GLuint body_texture_array = 0;
+std::size_t body_texture_width = 0;
+std::size_t body_texture_height = 0;
+std::vector<bool> body_layer_loaded;
+texture_obj skydome_texture{pixel_data{}};
+// samples per texel footprint along its longer axis, where supported
+const float max_anisotropy = 8.0f;
+
+// per draw parameters are fetched by draw id in simple.vert,
+// model matrix, normal matrix and color with texture layer
+const GLuint draw_id_location = 3;
+const std::size_t texels_per_draw = 9;
+GLuint draw_parameter_texture = 0;
+// generation of the stream buffer the texture currently reads from
+std::size_t draw_parameter_generation = 0;
+std::vector<glm::fvec4> draw_parameters;
+
+// initial size of the per frame region in the stream buffer
+const std::size_t frame_data_bytes = 1 << 16;
 
 bool vertical_screen_flip = false;
 bool horizontal_screen_flip = false;
 bool greyscaling_screen = false;
 bool gaussian_smooth_screen = false;
+// draw skydome last at the far plane instead of first behind everything
+bool skydome_far_plane = true;
 
 const float earth_size = 1.0f;
 
+// full size of the offscreen scene target, taken from the framebuffer
+// of the window at startup, so it follows the launcher resolution
+GLsizei offscreen_width = 0;
+GLsizei offscreen_height = 0;
+// scene is rendered into a sub-rect of the target to hold 60 fps
+resolution_scaler dynamic_resolution{1.0 / 60.0, 0.5f, 1.0f};
+double last_frame_time = 0.0;
+
+// simulation time of the last two fixed updates
+double simulation_time = 0.0;
+double previous_simulation_time = 0.0;
+
+// drop objects outside the frustum or smaller than a pixel
+frustum_culler scene_culler{1.0f};
+// bounding spheres of all bodies, star field last
+sphere_set scene_bounds;
+std::vector<std::uint8_t> scene_visibility;
+// moon orbit extends earth bounds, relative to earth radius
+const float moon_system_radius = 1.8f;
+
+// camera used for frame preparation
+struct camera_state {
+  glm::fmat4 view_transform;
+  glm::fmat4 projection;
+  float viewport_height = 1.0f;
+};
+
+// body transformed and ready to draw
+struct body_draw {
+  glm::fmat4 model_matrix;
+  glm::fmat4 normal_matrix;
+  glm::fvec3 color;
+  // layer in the body texture array
+  std::size_t texture_layer;
+  // sphere level of detail the body is drawn with
+  std::size_t lod;
+  // visible meshlet ranges of the body in the frame ranges
+  std::size_t first_range;
+  std::size_t range_count;
+};
+
+// generated sphere of one level of detail with its meshlets
+struct sphere_lod {
+  mesh_range mesh;
+  std::vector<meshlet> meshlets;
+};
+// levels from coarse to fine, created before frame preparation starts
+std::vector<sphere_lod> sphere_lods;
+const unsigned sphere_lod_count = 5;
+// level with as many triangles as the former sphere model, used for the skydome
+const unsigned skydome_lod = 3;
+// bodies use the finest level whose edges are at least this many pixels long
+const float lod_edge_pixels = 8.0f;
+
+// model in the geometry pool with its material ranges
+struct pooled_model {
+  mesh_range mesh;
+  std::vector<submesh> submeshes;
+  std::vector<material> materials;
+};
+// satellite orbiting earth, streamed from gltf and drawn once per material,
+// only touched on the gl thread, without submeshes until it is loaded
+pooled_model satellite;
+
+// everything rendering needs from simulation and culling
+struct frame_snapshot {
+  // visible bodies sorted front to back
+  std::vector<body_draw> bodies;
+  // index ranges of visible meshlets relative to the sphere mesh of their body
+  std::vector<index_range> ranges;
+  meshlet_stats meshlets;
+  // satellite is drawn whenever the earth system is visible
+  bool satellite_visible = false;
+  glm::fmat4 satellite_matrix;
+  glm::fmat4 satellite_normal_matrix;
+  bool stars_visible = false;
+  culling_stats culling;
+};
+
+// frame preparation may run on the simulation thread, so it only
+// exchanges state with rendering through these buffers
+triple_buffer<camera_state> camera_states;
+triple_buffer<frame_snapshot> frame_snapshots;
+// snapshot of the frame being rendered, fixed for the whole frame
+frame_snapshot const* current_frame = nullptr;
+
+// limit gpu uploads of streamed assets to avoid hitches
+const std::size_t assets_per_frame = 2;
+
 ApplicationSolar::ApplicationSolar(std::string const& resource_path)
  :Application{resource_path}
- ,m_obj_planet{},m_obj_star{},m_obj_skydome{}
+ ,m_obj_star{}
+ ,m_geometry{sphere_layout{}, "scene geometry"}
+ ,m_sphere_mesh{}
+ ,m_frame_data{frame_data_bytes, "frame data"}
+ ,m_body_batch{m_geometry, draw_id_location, "body draws"}
+ ,m_assets{}
 {  
   initializePlanets();
   initializeSkydome();
   initializeStars();
   initializeScreenQuadGeometry();
+  glfwGetFramebufferSize(glfwGetCurrentContext(), &offscreen_width, &offscreen_height);
+  initializeRenderBuffer(offscreen_width, offscreen_height);
+  initializeFrameBuffers(offscreen_width, offscreen_height);
   initializeShaderPrograms();
 }
 
-void ApplicationSolar::upload_planet_transforms(struct planet pl) const {
-  // bind shader to upload uniforms
-  glUseProgram(m_shaders.at("planet").handle); 
-
-  //Calculate model and normal matrices and render
-  glm::fmat4 size = glm::scale(glm::mat4{}, glm::vec3{pl.size}); 
-  glm::fmat4 model_matrix = glm::rotate(size, float(glfwGetTime()) * pl.speed, glm::fvec3{0.0f, pl.rotation, 0.0f});  
-  model_matrix = glm::translate(model_matrix, glm::fvec3{0.0f, 0.0f, -pl.distance});
-  glm::fmat4 normal_matrix = glm::inverseTranspose(glm::inverse(m_view_transform) * model_matrix);
-
-  
-  glUniformMatrix4fv(m_shaders.at("planet").u_locs.at("ModelMatrix"),
-                     1, GL_FALSE, glm::value_ptr(model_matrix));
-
-  // extra matrix for normal transformation to keep them orthogonal to surface
-  
-  glUniformMatrix4fv(m_shaders.at("planet").u_locs.at("NormalMatrix"),
-                     1, GL_FALSE, glm::value_ptr(normal_matrix));
-
-  glUniform3f(m_shaders.at("planet").u_locs.at("ColorVec"), pl.color[0], pl.color[1], pl.color[2]);
+// single pixel texture shown until the real one is streamed in
+pixel_data placeholder_pixels(glm::fvec3 const& color) {
+  std::vector<std::uint8_t> pixel{std::uint8_t(color.r * 255.0f), std::uint8_t(color.g * 255.0f),
+                                  std::uint8_t(color.b * 255.0f), 255};
+  return pixel_data{pixel, GL_RGBA, GL_UNSIGNED_BYTE, 1, 1};
+}
 
-  
+// replace texture object by one holding the image with its mip chain,
+// immutable storage can not be resized, so later images need a new object
+void upload_texture(texture_obj& texture, std::string const& owner) {
   glActiveTexture(GL_TEXTURE0);
-  glBindTexture(planet_textures[pl.order].target,planet_textures[pl.order].tex_obj);
-  glUniform1i(m_shaders.at("planet").u_locs.at("Texture"), 0);
-
-
-  // bind the VAO to draw
-  glBindVertexArray(m_obj_planet.vertex_AO);
 
-  // draw bound vertex array using bound shader
-  glDrawElements(m_obj_planet.draw_mode, m_obj_planet.num_elements, model::INDEX.type, NULL);
-
-  //Create moon for earth distinguishing by size
-  if(pl.size == 1.0f)
-  {
+  if (texture.tex_obj != 0) {
+    glDeleteTextures(1, &texture.tex_obj);
+    MEMORY_RELEASE(texture, texture.tex_obj);
+  }
+  texture_object object = utils::create_texture_object(texture.tex, max_anisotropy);
+  texture.target = object.target;
+  texture.tex_obj = object.handle;
+  MEMORY_TRACK(texture, texture.tex_obj,
+               memory_tracker::texture_bytes(utils::sized_format(texture.tex.channels, texture.tex.channel_type),
+                                             texture.tex.width, texture.tex.height, true), owner);
+
+  // gpu holds the image now, keep only its format and dimensions
+  std::vector<std::uint8_t>{}.swap(texture.tex.pixels);
+}
 
-    glm::mat4 MoonSize = glm::scale(model_matrix, glm::vec3{ 0.2f });
-    glm::mat4 model_matrix = glm::rotate(MoonSize, float(glfwGetTime()), glm::vec3{ 0.0f, 1.0f, 0.0f }); // axis of rotation
-    model_matrix = glm::translate(model_matrix, glm::vec3{ 0.0f, 0.0f, -8.0f }); // radius length
-    glm::mat4 normal_matrix = glm::inverseTranspose(glm::inverse(m_view_transform) * model_matrix);
+// copy image into its layer of the body texture array,
+// the array takes the size of the first image uploaded
+void upload_body_layer(std::size_t layer, pixel_data const& pixels) {
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, body_texture_array);
+
+  if (body_texture_width == 0) {
+    body_texture_width = pixels.width;
+    body_texture_height = pixels.height;
+    utils::allocate_texture_storage(GL_TEXTURE_2D_ARRAY, utils::mip_levels(body_texture_width, body_texture_height),
+                                    GL_RGBA8, body_texture_width, body_texture_height, body_layer_loaded.size());
+    MEMORY_TRACK(texture, body_texture_array,
+                 memory_tracker::texture_bytes(GL_RGBA8, body_texture_width, body_texture_height, true) * body_layer_loaded.size(),
+                 "body textures");
+  }
+  else if (pixels.width != body_texture_width || pixels.height != body_texture_height) {
+    // layers can not differ in size, the body keeps showing its color
+    std::cerr << "body texture " << layer << " is " << pixels.width << "x" << pixels.height << " instead of "
+              << body_texture_width << "x" << body_texture_height << std::endl;
+    return;
+  }
 
-    glUniformMatrix4fv(m_shaders.at("planet").u_locs.at("ModelMatrix"),
-                     1, GL_FALSE, glm::value_ptr(model_matrix));
+  // rows of rgb images are not padded to 4 bytes
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, GLint(layer),
+                  GLsizei(pixels.width), GLsizei(pixels.height), 1,
+                  pixels.channels, pixels.channel_type, pixels.pixels.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  // rebuilds the levels of all layers, but layers arrive only a few times
+  glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+  body_layer_loaded[layer] = true;
+}
 
-  // extra matrix for normal transformation to keep them orthogonal to surface
-  
-    glUniformMatrix4fv(m_shaders.at("planet").u_locs.at("NormalMatrix"),
-                     1, GL_FALSE, glm::value_ptr(normal_matrix));
+// calculate model matrix of a body at given time
+glm::fmat4 planet_model_matrix(struct planet const& pl, double time) {
+  glm::fmat4 size = glm::scale(glm::mat4{}, glm::vec3{pl.size}); 
+  glm::fmat4 model_matrix = glm::rotate(size, float(time) * pl.speed, glm::fvec3{0.0f, pl.rotation, 0.0f});  
+  return glm::translate(model_matrix, glm::fvec3{0.0f, 0.0f, -pl.distance});
+}
 
-    glUniform3f(m_shaders.at("planet").u_locs.at("ColorVec"), 1.0f, 1.0f, 1.0f);
+// calculate model matrix of the moon from the model matrix of the earth
+glm::fmat4 moon_model_matrix(glm::fmat4 const& earth_matrix, double time) {
+  glm::mat4 MoonSize = glm::scale(earth_matrix, glm::vec3{ 0.2f });
+  glm::mat4 model_matrix = glm::rotate(MoonSize, float(time), glm::vec3{ 0.0f, 1.0f, 0.0f }); // axis of rotation
+  return glm::translate(model_matrix, glm::vec3{ 0.0f, 0.0f, -8.0f }); // radius length
+}
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(other_textures[0].target,other_textures[0].tex_obj);
-    glUniform1i(m_shaders.at("planet").u_locs.at("Texture"), 0);
+// satellite circles earth inside the moon orbit on a tilted plane
+glm::fmat4 satellite_model_matrix(glm::fmat4 const& earth_matrix, double time) {
+  glm::fmat4 tilted = glm::rotate(earth_matrix, 0.5f, glm::fvec3{1.0f, 0.0f, 0.0f});
+  glm::fmat4 model_matrix = glm::rotate(tilted, float(time) * 3.0f, glm::fvec3{0.0f, 1.0f, 0.0f});
+  return glm::scale(glm::translate(model_matrix, glm::fvec3{0.0f, 0.0f, -1.3f}), glm::fvec3{0.08f});
+}
 
-    // bind the VAO to draw
-    glBindVertexArray(m_obj_planet.vertex_AO);
+bool ApplicationSolar::loading() const {
+    return m_assets.pending() > 0;
+}
 
-    // draw bound vertex array using bound shader
-    glDrawElements(m_obj_planet.draw_mode, m_obj_planet.num_elements, model::INDEX.type, NULL);
-  }
+void ApplicationSolar::update(double timestep) {
+    previous_simulation_time = simulation_time;
+    simulation_time += timestep;
 }
 
 void ApplicationSolar::render() const {  
+    // swap in streamed assets, benchmarks take all to start measuring sooner
+    m_assets.poll(m_deterministic ? std::size_t(-1) : assets_per_frame);
+
+    // adapt scene resolution to duration of last frame
+    double current_time = glfwGetTime();
+    // benchmarks keep the full resolution
+    if (last_frame_time > 0.0 && !m_deterministic) {
+      dynamic_resolution.update(current_time - last_frame_time);
+    }
+    last_frame_time = current_time;
+    // culling of next frame depends on resolution
+    publishCamera();
+    current_frame = &frame_snapshots.read_buffer();
+    // wait for the gpu to release the oldest frame region, it must hold
+    // draw parameters of all bodies and an indirect command per meshlet range,
+    // the satellite adds parameters per material and a command per submesh
+    std::size_t num_draws = std::max(current_frame->ranges.size(), current_frame->bodies.size()) + satellite.submeshes.size();
+    m_frame_data.begin_frame((current_frame->bodies.size() + satellite.materials.size()) * texels_per_draw * sizeof(glm::fvec4)
+                             + num_draws * sizeof(draw_elements_command) + 32);
+
+    // remember window viewport for the screen quad pass
+    GLint window_viewport[4];
+    glGetIntegerv(GL_VIEWPORT, window_viewport);
+
     glBindFramebuffer(GL_FRAMEBUFFER, fbo_handle);
+    // render only into sub-rect of target to avoid reallocation
+    glViewport(0, 0, dynamic_resolution.scaled(offscreen_width), dynamic_resolution.scaled(offscreen_height));
   
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glClearDepth(1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    renderSkydome();
-    renderStars();  
-    renderPlanets();
+    if (skydome_far_plane) {
+      // opaque geometry first, skydome only fills the remaining pixels
+      renderPlanets();
+      renderStars();
+      renderSkydome();
+    }
+    else {
+      renderSkydome();
+      renderStars();  
+      renderPlanets();
+    }
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(window_viewport[0], window_viewport[1], window_viewport[2], window_viewport[3]);
   
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glClearDepth(1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     renderScreenQuad();
+    m_frame_data.end_frame();
+}
+
+// runs on the simulation thread, must not issue gl calls or read camera members
+void ApplicationSolar::prepareFrame() {
+    camera_state const& camera = camera_states.read_buffer();
+    frame_snapshot& frame = frame_snapshots.write_buffer();
+
+    // blend between the last two simulation steps, all bodies share this time
+    double render_time = previous_simulation_time + (simulation_time - previous_simulation_time) * m_interpolation;
+
+    std::vector<glm::fmat4> model_matrices;
+    model_matrices.reserve(planets.size());
+    scene_bounds.clear();
+    for (auto const& pl : planets) {
+      model_matrices.push_back(planet_model_matrix(pl, render_time));
+      // earth is distinguished by size, its bounds contain the moon
+      float radius = pl.size == 1.0f ? moon_system_radius * pl.size : pl.size;
+      scene_bounds.add(glm::fvec3{model_matrices.back()[3]}, radius);
+    }
+    scene_bounds.add(star_bounds_center, star_bounds_radius);
+
+    glm::fmat4 view_matrix = glm::inverse(camera.view_transform);
+    scene_culler.update(view_matrix, camera.projection, camera.viewport_height);
+    scene_culler.cull(scene_bounds, scene_visibility);
+    frame.culling = scene_culler.stats();
+    frame.stars_visible = scene_visibility.back() != 0;
+
+    //Sort visible bodies front to back by distance of their surface to the camera,
+    //so the early depth test rejects fragments of hidden bodies
+    glm::fvec3 camera_position{camera.view_transform[3]};
+    std::vector<std::pair<float, std::size_t>> sorted_planets;
+    sorted_planets.reserve(planets.size());
+    for (std::size_t i = 0; i < planets.size(); ++i) {
+      if (!scene_visibility[i]) continue;
+      glm::fvec3 position{scene_bounds.x[i], scene_bounds.y[i], scene_bounds.z[i]};
+      sorted_planets.emplace_back(glm::length(position - camera_position) - scene_bounds.radius[i], i);
+    }
+    std::sort(sorted_planets.begin(), sorted_planets.end());
+
+    frame.ranges.clear();
+    frame.bodies.clear();
+    frame.satellite_visible = false;
+    // bodies pick their level by projected size and keep only meshlets inside
+    // the frustum and facing the camera, bodies without any are dropped
+    auto add_body = [&](glm::fmat4 const& model_matrix, glm::fvec3 const& color, std::size_t layer) {
+      // level l has 8 << l segments around the circumference
+      float diameter = scene_culler.projected_size(glm::fvec3{model_matrix[3]}, glm::length(glm::fvec3{model_matrix[0]}));
+      float level = std::floor(std::log2(diameter * glm::pi<float>() / (8.0f * lod_edge_pixels)));
+      std::size_t lod = std::size_t(glm::clamp(level, 0.0f, float(sphere_lod_count - 1)));
+      std::size_t first_range = frame.ranges.size();
+      scene_culler.cull_meshlets(sphere_lods[lod].meshlets, model_matrix, frame.ranges);
+      if (frame.ranges.size() == first_range) return;
+      // extra matrix for normal transformation to keep them orthogonal to surface
+      frame.bodies.push_back(body_draw{model_matrix, glm::inverseTranspose(view_matrix * model_matrix),
+                                       color, layer, lod, first_range, frame.ranges.size() - first_range});
+    };
+    for (auto const& entry : sorted_planets) {
+      struct planet const& pl = planets[entry.second];
+      glm::fmat4 const& model_matrix = model_matrices[entry.second];
+      add_body(model_matrix, pl.color, std::size_t(pl.order));
+      //Create moon for earth distinguishing by size
+      if (pl.size == 1.0f) {
+        add_body(moon_model_matrix(model_matrix, render_time), glm::fvec3{0.6f}, planets.size());
+        frame.satellite_visible = true;
+        frame.satellite_matrix = satellite_model_matrix(model_matrix, render_time);
+        frame.satellite_normal_matrix = glm::inverseTranspose(view_matrix * frame.satellite_matrix);
+      }
+    }
+    frame.meshlets = scene_culler.meshlet_statistics();
+
+    frame_snapshots.publish();
+}
+
+// hand camera to frame preparation
+void ApplicationSolar::publishCamera() const {
+    camera_state& camera = camera_states.write_buffer();
+    camera.view_transform = m_view_transform;
+    camera.projection = m_view_projection;
+    camera.viewport_height = float(dynamic_resolution.scaled(offscreen_height));
+    camera_states.publish();
 }
 
 void ApplicationSolar::renderPlanets() const {   
-    //Iterate the container which holds the sun and planets and send
-    //each to upload_planet_transforms to set objects and render
-    for(std::vector<struct planet>::iterator it = planets.begin(); it != planets.end(); ++it) {    
-      struct planet pl = *it;
-      upload_planet_transforms(pl);      
+    profile_scope pass_scope{m_profiler, "planets"};
+    glUseProgram(m_shaders.at("planet").handle);
+
+    //All bodies share the sphere, so they are submitted as one batch
+    //and each draw fetches its parameters by draw id
+    m_body_batch.clear();
+    draw_parameters.clear();
+    auto add_parameters = [](glm::fmat4 const& model_matrix, glm::fmat4 const& normal_matrix,
+                             glm::fvec3 const& color, float layer) {
+      for (int column = 0; column < 4; ++column) {
+        draw_parameters.push_back(model_matrix[column]);
+      }
+      for (int column = 0; column < 4; ++column) {
+        draw_parameters.push_back(normal_matrix[column]);
+      }
+      draw_parameters.push_back(glm::fvec4{color, layer});
+    };
+    for (std::size_t i = 0; i < current_frame->bodies.size(); ++i) {
+      body_draw const& body = current_frame->bodies[i];
+      // one draw per visible meshlet range, all fetch the parameters of the body
+      for (std::size_t r = body.first_range; r < body.first_range + body.range_count; ++r) {
+        index_range const& range = current_frame->ranges[r];
+        m_body_batch.add(sub_range(sphere_lods[body.lod].mesh, range.offset, range.count), GLuint(i));
+      }
+      // bodies without texture yet are drawn in their color
+      float layer = body_layer_loaded[body.texture_layer] ? float(body.texture_layer) : -1.0f;
+      add_parameters(body.model_matrix, body.normal_matrix, body.color, layer);
     }
-  
+    // one draw per submesh, the draw ids after the bodies select the material,
+    // material textures are not part of the body array, so surfaces show their diffuse color
+    if (current_frame->satellite_visible && !satellite.submeshes.empty()) {
+      m_body_batch.add(satellite.mesh, satellite.submeshes, GLuint(current_frame->bodies.size()));
+      for (auto const& surface : satellite.materials) {
+        add_parameters(current_frame->satellite_matrix, current_frame->satellite_normal_matrix, surface.diffuse, -1.0f);
+      }
+    }
+    if (draw_parameters.empty()) return;
+
+    // copy into the region of this frame, no gl synchronization involved
+    std::size_t offset = m_frame_data.write(draw_parameters.data(), draw_parameters.size() * sizeof(glm::fvec4),
+                                            sizeof(glm::fvec4));
+    glUniform1i(m_shaders.at("planet").u_locs.at("DrawParameterOffset"), GLint(offset / sizeof(glm::fvec4)));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, body_texture_array);
+    glUniform1i(m_shaders.at("planet").u_locs.at("Textures"), 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, draw_parameter_texture);
+    // stream buffer is replaced when its regions grow, possibly under the same name
+    if (draw_parameter_generation != m_frame_data.generation()) {
+      draw_parameter_generation = m_frame_data.generation();
+      glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_frame_data.buffer());
+    }
+    glUniform1i(m_shaders.at("planet").u_locs.at("DrawParameters"), 1);
+    glActiveTexture(GL_TEXTURE0);
+
+    m_body_batch.submit(m_frame_data);
 }
 
 void ApplicationSolar::renderSkydome() const {   
+    profile_scope pass_scope{m_profiler, "skydome"};
     glUseProgram(m_shaders.at("skydome").handle);
+    glUniform1i(m_shaders.at("skydome").u_locs.at("FarPlaneActive"), skydome_far_plane);
+    if (skydome_far_plane) {
+      // skydome lies exactly on far plane, only pass where nothing was drawn
+      glDepthFunc(GL_LEQUAL);
+      glDepthMask(GL_FALSE);
+    }
 
     glm::fmat4 size = glm::scale(glm::mat4{}, glm::vec3{60.0f}); 
     glm::fmat4 model_matrix = glm::rotate(size, 0.0f , glm::fvec3{0.0f, 0.1f, 0.0f});
@@ -198,24 +535,30 @@ void ApplicationSolar::renderSkydome() const {
                        1, GL_FALSE, glm::value_ptr(normal_matrix));
 
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(other_textures[1].target,other_textures[1].tex_obj);
+    glBindTexture(skydome_texture.target, skydome_texture.tex_obj);
     glUniform1i(m_shaders.at("skydome").u_locs.at("Texture"), 0);
 
-    // bind the VAO to draw
-    glBindVertexArray(m_obj_skydome.vertex_AO);
+    // draw sphere range of the geometry pool using bound shader
+    m_geometry.bind();
+    m_geometry.draw(m_sphere_mesh);
 
-    // draw bound vertex array using bound shader
-    glDrawElements(m_obj_skydome.draw_mode, m_obj_skydome.num_elements, model::INDEX.type, NULL);
-
-  
+    if (skydome_far_plane) {
+      glDepthFunc(GL_LESS);
+      glDepthMask(GL_TRUE);
+    }
 }
 
 void ApplicationSolar::renderScreenQuad() const{
+   profile_scope pass_scope{m_profiler, "screen quad"};
    glUseProgram(m_shaders.at("quad").handle);
  
    glActiveTexture(GL_TEXTURE0);
    glBindTexture(GL_TEXTURE_2D, screen_quad_texture.obj_ptr);
    glUniform1i(m_shaders.at("quad").u_locs.at("ColorTex"), 0);
+   // upscale the rendered sub-rect to the whole screen
+   glUniform2f(m_shaders.at("quad").u_locs.at("ResolutionScale"),
+               GLfloat(dynamic_resolution.scaled(offscreen_width)) / GLfloat(offscreen_width),
+               GLfloat(dynamic_resolution.scaled(offscreen_height)) / GLfloat(offscreen_height));
  
    glBindVertexArray(screen_quad_object.vertex_AO);
    utils::validate_program(m_shaders.at("quad").handle);
@@ -224,6 +567,9 @@ void ApplicationSolar::renderScreenQuad() const{
 }
 
 void ApplicationSolar::renderStars() const {
+  profile_scope pass_scope{m_profiler, "stars"};
+  // star field is culled as a whole
+  if (!current_frame->stars_visible) return;
 
   glUseProgram(m_shaders.at("stars").handle); 
   // bind the VAO to draw
@@ -234,8 +580,6 @@ void ApplicationSolar::renderStars() const {
 }
 
 void ApplicationSolar::updateView() {
-  initializeRenderBuffer(2048, 960);
-  initializeFrameBuffers(2048, 960);
   // vertices are transformed in camera space, so camera transform must be inverted
 
   glm::fmat4 view_matrix = glm::inverse(m_view_transform);
@@ -254,8 +598,9 @@ void ApplicationSolar::updateView() {
 
   glUseProgram(m_shaders.at("quad").handle);
   glUniformMatrix4fv(m_shaders.at("quad").u_locs.at("ViewMatrix"), 1, GL_FALSE, glm::value_ptr(view_matrix));
-  glUniform2f(m_shaders.at("quad").u_locs.at("Resolution"), GLfloat(2048), GLfloat(960));
+  glUniform2f(m_shaders.at("quad").u_locs.at("Resolution"), GLfloat(offscreen_width), GLfloat(offscreen_height));
 
+  publishCamera();
 }
 
 void ApplicationSolar::updateProjection() {
@@ -269,6 +614,8 @@ void ApplicationSolar::updateProjection() {
   glUseProgram(m_shaders.at("stars").handle);
   glUniformMatrix4fv(m_shaders.at("stars").u_locs.at("ProjectionMatrix"),
                      1, GL_FALSE, glm::value_ptr(m_view_projection));
+
+  publishCamera();
 }
 
 
@@ -279,6 +626,11 @@ void ApplicationSolar::uploadUniforms() {
   
   updateView();
   updateProjection();
+
+  // parameters of the procedural star field
+  glUseProgram(m_shaders.at("stars").handle);
+  glUniform1ui(m_shaders.at("stars").u_locs.at("Seed"), star_seed);
+  glUniform2f(m_shaders.at("stars").u_locs.at("Distances"), star_min_distance, star_max_distance);
 }
 
 // handle key input
@@ -291,6 +643,23 @@ void ApplicationSolar::keyCallback(int key, int scancode, int action, int mods)
       m_view_transform = glm::translate(m_view_transform, glm::fvec3{0.0f, 0.0f, 0.1f});
       updateView();
     }
+    else if (key == GLFW_KEY_C && action == GLFW_PRESS && current_frame)
+    { // print result of culling pass of last rendered frame
+      culling_stats const& stats = current_frame->culling;
+      std::cout << "Culling: " << stats.visible << " of " << stats.tested << " visible, "
+                << stats.frustum_culled << " outside frustum, "
+                << stats.size_culled << " below " << scene_culler.min_pixel_size << " pixel" << std::endl;
+      meshlet_stats const& meshlets = current_frame->meshlets;
+      std::cout << "Meshlets: " << meshlets.visible << " of " << meshlets.tested << " visible, "
+                << meshlets.frustum_culled << " outside frustum, "
+                << meshlets.size_culled << " below pixel size, "
+                << meshlets.backface_culled << " backfacing, "
+                << meshlets.triangles_visible << " of " << meshlets.triangles_tested << " triangles drawn" << std::endl;
+    }
+    else if (key == GLFW_KEY_6 && action == GLFW_PRESS)
+    { // skydome at far plane
+      skydome_far_plane = !skydome_far_plane;
+    }
     else if (key == GLFW_KEY_7 && action == GLFW_PRESS)
     { // greyscale active
       greyscaling_screen = !greyscaling_screen;
@@ -328,6 +697,7 @@ void ApplicationSolar::initializeShaderPrograms() {
   m_shaders.at("skydome").u_locs["ViewMatrix"] = -1;
   m_shaders.at("skydome").u_locs["ProjectionMatrix"] = -1;
   m_shaders.at("skydome").u_locs["Texture"] = -1;
+  m_shaders.at("skydome").u_locs["FarPlaneActive"] = -1;
     // store shader program objects in container
   m_shaders.emplace("stars", shader_program{m_resource_path + "shaders/stars.vert",
                                            m_resource_path + "shaders/stars.frag"});
@@ -335,17 +705,18 @@ void ApplicationSolar::initializeShaderPrograms() {
   
   m_shaders.at("stars").u_locs["ViewMatrix"] = 0;
   m_shaders.at("stars").u_locs["ProjectionMatrix"] = 0;
+  m_shaders.at("stars").u_locs["Seed"] = -1;
+  m_shaders.at("stars").u_locs["Distances"] = -1;
 
   // store shader program objects in container
   m_shaders.emplace("planet", shader_program{m_resource_path + "shaders/simple.vert",
                                            m_resource_path + "shaders/simple.frag"});
   // request uniform locations for shader program
-  m_shaders.at("planet").u_locs["NormalMatrix"] = -1;
-  m_shaders.at("planet").u_locs["ModelMatrix"] = -1;
   m_shaders.at("planet").u_locs["ViewMatrix"] = -1;
   m_shaders.at("planet").u_locs["ProjectionMatrix"] = -1;
-  m_shaders.at("planet").u_locs["ColorVec"] = -1;
-  m_shaders.at("planet").u_locs["Texture"] = -1;
+  m_shaders.at("planet").u_locs["DrawParameters"] = -1;
+  m_shaders.at("planet").u_locs["DrawParameterOffset"] = -1;
+  m_shaders.at("planet").u_locs["Textures"] = -1;
 
   // store shader program objects in container
   m_shaders.emplace("quad", shader_program{m_resource_path + "shaders/quad.vert",
@@ -356,6 +727,7 @@ void ApplicationSolar::initializeShaderPrograms() {
   m_shaders.at("quad").u_locs["ProjectionMatrix"] = -1;
   m_shaders.at("quad").u_locs["ColorTex"] = -1;
   m_shaders.at("quad").u_locs["Resolution"] = -1;
+  m_shaders.at("quad").u_locs["ResolutionScale"] = -1;
   m_shaders.at("quad").u_locs["GreyscaleActive"] = -1;
   m_shaders.at("quad").u_locs["FlipHorizontalActive"] = -1;
   m_shaders.at("quad").u_locs["FlipVerticalActive"] = -1;
@@ -456,212 +828,64 @@ void ApplicationSolar::initializePlanets() {
     planets[8].color = {0.24f,0.48f,0.80f};
     planets[8].order = 8;
 
-    for (auto planet: planets) {
-        planet_textures.push_back(texture_loader::file(m_resource_path + "textures/" + planet.name + ".png"));
+    //Bodies show their color until their layer is streamed in, moon is the last layer
+    body_layer_loaded.assign(planets.size() + 1, false);
+    glGenTextures(1, &body_texture_array);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, body_texture_array);
+    //Distant bodies sample small levels, so texture bandwidth does not grow with the image size
+    utils::set_mipmap_filtering(GL_TEXTURE_2D_ARRAY, max_anisotropy);
+
+    for (auto const& planet : planets) {
+      std::size_t layer = std::size_t(planet.order);
+      m_assets.request_texture(m_resource_path + "textures/" + planet.name + ".png", [layer](pixel_data& pixels) {
+        upload_body_layer(layer, pixels);
+      });
     }
-
-    for (auto planet: planets){
-      glActiveTexture(GL_TEXTURE0);
-
-      // generate a new texture object
-      glGenTextures(1, &planet_textures[planet.order].tex_obj);
-
-      // bind the texture to the current context and target
-      glBindTexture(planet_textures[planet.order].target, planet_textures[planet.order].tex_obj);
-
-      // set texture sampling parameters
-      glTexParameteri(planet_textures[planet.order].target, GL_TEXTURE_MIN_FILTER, GLint(GL_LINEAR));
-      glTexParameteri(planet_textures[planet.order].target, GL_TEXTURE_MAG_FILTER, GLint(GL_LINEAR));
-
-      glTexImage2D(planet_textures[planet.order].target,
-        0, // mipmaps
-        GLint(GL_RGBA),
-        planet_textures[planet.order].tex.width, planet_textures[planet.order].tex.height,
-        0, // no border
-        GL_RGBA,
-        planet_textures[planet.order].tex.channel_type,
-        planet_textures[planet.order].tex.pixels.data()
-      );
+    std::size_t moon_layer = planets.size();
+    m_assets.request_texture(m_resource_path + "textures/moon.png", [moon_layer](pixel_data& pixels) {
+      upload_body_layer(moon_layer, pixels);
+    });
+
+    //Parameters of all draws are read from the frame data through one buffer texture
+    glGenTextures(1, &draw_parameter_texture);
+
+    //Spheres are generated instead of loaded, one per level of detail,
+    //their meshlets are culled per body
+    sphere_lods.clear();
+    for (unsigned level = 0; level < sphere_lod_count; ++level) {
+      model sphere = procedural_mesh::uv_sphere(level, sphere_layout::flags);
+      model_loader::build_meshlets(sphere);
+      sphere_lod lod;
+      lod.mesh = m_geometry.allocate(sphere);
+      lod.meshlets = std::move(sphere.meshlets);
+      sphere_lods.push_back(std::move(lod));
     }
-
-    other_textures.push_back(texture_loader::file(m_resource_path + "textures/moon.png")); 
-
-    glActiveTexture(GL_TEXTURE0);
-
-      // generate a new texture object
-      glGenTextures(1, &other_textures[0].tex_obj);
-
-      // bind the texture to the current context and target
-      glBindTexture(other_textures[0].target, other_textures[0].tex_obj);
-
-      // set texture sampling parameters
-      glTexParameteri(other_textures[0].target, GL_TEXTURE_MIN_FILTER, GLint(GL_LINEAR));
-      glTexParameteri(other_textures[0].target, GL_TEXTURE_MAG_FILTER, GLint(GL_LINEAR));
-
-      glTexImage2D(other_textures[0].target,
-        0, // mipmaps
-        GLint(GL_RGBA),
-        other_textures[0].tex.width, other_textures[0].tex.height,
-        0, // no border
-        GL_RGBA,
-        other_textures[0].tex.channel_type,
-        other_textures[0].tex.pixels.data()
-      ); 
-
-
-    model planet_model = model_loader::obj(m_resource_path + "models/sphere.obj", model::NORMAL | model::TEXCOORD);
-    
-    // generate vertex array object
-    glGenVertexArrays(1, &m_obj_planet.vertex_AO);
-    // bind the array for attaching buffers
-    glBindVertexArray(m_obj_planet.vertex_AO);
-
-    // generate generic buffer
-    glGenBuffers(1, &m_obj_planet.vertex_BO);
-    // bind this as an vertex array buffer containing all attributes
-    glBindBuffer(GL_ARRAY_BUFFER, m_obj_planet.vertex_BO);
-    // configure currently bound array buffer
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * planet_model.data.size(), planet_model.data.data(), GL_STATIC_DRAW);
-
-    // activate first attribute on gpu
-    glEnableVertexAttribArray(0);
-    // first attribute is 3 floats with no offset & stride
-    glVertexAttribPointer(0, model::POSITION.components, (gl::GLenum) model::POSITION.type, GL_FALSE, planet_model.vertex_bytes, planet_model.offsets[model::POSITION]);
-    // activate second attribute on gpu
-    glEnableVertexAttribArray(1);
-    // second attribute is 3 floats with no offset & stride
-    glVertexAttribPointer(1, model::NORMAL.components, (gl::GLenum) model::NORMAL.type, GL_FALSE, planet_model.vertex_bytes, planet_model.offsets[model::NORMAL]);
-    // activate second attribute on gpu
-    glEnableVertexAttribArray(2);
-    // second attribute is 3 floats with no offset & stride
-    glVertexAttribPointer(2, model::TEXCOORD.components, (gl::GLenum) model::TEXCOORD.type, GL_FALSE, planet_model.vertex_bytes, planet_model.offsets[model::TEXCOORD]);
- 
-     // generate generic buffer
-    glGenBuffers(1, &m_obj_planet.element_BO);
-    // bind this as an vertex array buffer containing all attributes
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_obj_planet.element_BO);
-    // configure currently bound array buffer
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, model::INDEX.size * planet_model.indices.size(), planet_model.indices.data(), GL_STATIC_DRAW);
-
-
-      // store type of primitive to draw
-    m_obj_planet.draw_mode = GL_TRIANGLES;
-    // transfer number of indices to model object 
-    m_obj_planet.num_elements = GLsizei(planet_model.indices.size()); 
+    //Skydome shares the sphere with the planets
+    m_sphere_mesh = sphere_lods[skydome_lod].mesh;
+
+    m_assets.request_model(m_resource_path + "models/cube.glb", sphere_layout::flags, [this](model& loaded) {
+      satellite.mesh = m_geometry.allocate(loaded);
+      satellite.submeshes = loaded.submeshes;
+      satellite.materials = loaded.materials;
+    });
 }
 void ApplicationSolar::initializeSkydome() {
-  
-    other_textures.push_back(texture_loader::file(m_resource_path + "textures/skydome.png"));  
-
-    glActiveTexture(GL_TEXTURE0);
-
-      // generate a new texture object
-      glGenTextures(1, &other_textures[1].tex_obj);
-
-      // bind the texture to the current context and target
-      glBindTexture(other_textures[1].target, other_textures[1].tex_obj);
-
-      // set texture sampling parameters
-      glTexParameteri(other_textures[1].target, GL_TEXTURE_MIN_FILTER, GLint(GL_LINEAR));
-      glTexParameteri(other_textures[1].target, GL_TEXTURE_MAG_FILTER, GLint(GL_LINEAR));
-
-      glTexImage2D(other_textures[1].target,
-        0, // mipmaps
-        GLint(GL_RGBA),
-        other_textures[1].tex.width, other_textures[1].tex.height,
-        0, // no border
-        GL_RGBA,
-        other_textures[1].tex.channel_type,
-        other_textures[1].tex.pixels.data()
-      );  
-
-    model planet_model = model_loader::obj(m_resource_path + "models/sphere.obj", model::NORMAL | model::TEXCOORD);
-
-    // generate vertex array object
-    glGenVertexArrays(1, &m_obj_skydome.vertex_AO);
-    // bind the array for attaching buffers
-    glBindVertexArray(m_obj_skydome.vertex_AO);
-
-    // generate generic buffer
-    glGenBuffers(1, &m_obj_skydome.vertex_BO);
-    // bind this as an vertex array buffer containing all attributes
-    glBindBuffer(GL_ARRAY_BUFFER, m_obj_skydome.vertex_BO);
-    // configure currently bound array buffer
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * planet_model.data.size(), planet_model.data.data(), GL_STATIC_DRAW);
-
-    // activate first attribute on gpu
-    glEnableVertexAttribArray(0);
-    // first attribute is 3 floats with no offset & stride
-    glVertexAttribPointer(0, model::POSITION.components, model::POSITION.type, GL_FALSE, planet_model.vertex_bytes, planet_model.offsets[model::POSITION]);
-    // activate second attribute on gpu
-    glEnableVertexAttribArray(1);
-    // second attribute is 3 floats with no offset & stride
-    glVertexAttribPointer(1, model::NORMAL.components, model::NORMAL.type, GL_FALSE, planet_model.vertex_bytes, planet_model.offsets[model::NORMAL]);
-    // activate second attribute on gpu
-    glEnableVertexAttribArray(2);
-    // second attribute is 3 floats with no offset & stride
-    glVertexAttribPointer(2, model::TEXCOORD.components, (gl::GLenum) model::TEXCOORD.type, GL_FALSE, planet_model.vertex_bytes, planet_model.offsets[model::TEXCOORD]);
-
-     // generate generic buffer
-    glGenBuffers(1, &m_obj_skydome.element_BO);
-    // bind this as an vertex array buffer containing all attributes
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_obj_skydome.element_BO);
-    // configure currently bound array buffer
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, model::INDEX.size * planet_model.indices.size(), planet_model.indices.data(), GL_STATIC_DRAW);
-
-    // store type of primitive to draw
-    m_obj_skydome.draw_mode = GL_TRIANGLES;
-    // transfer number of indices to model object 
-    m_obj_skydome.num_elements = GLsizei(planet_model.indices.size());
+    skydome_texture.tex = placeholder_pixels(glm::fvec3{0.0f});
+    upload_texture(skydome_texture, "skydome texture");
+    m_assets.request_texture(m_resource_path + "textures/skydome.png", [](pixel_data& pixels) {
+      skydome_texture.tex = std::move(pixels);
+      upload_texture(skydome_texture, "skydome texture");
+    });
 }
 void ApplicationSolar::initializeStars() {
-  std::vector<float> stars;
-  number_of_stars = int(fmod(std::rand() , 200));
-
-  //Store position and color values
-  for (int i=0;i<number_of_stars;i++) {
-    float x = float(fmod(std::rand() ,  50)) - float(fmod(std::rand() , 75));
-    float y = float(fmod(std::rand() ,  50)) - float(fmod(std::rand() , 75));
-    float z = -float(fmod(std::rand() , 50));
-
-    stars.push_back(x);
-    stars.push_back(y);
-    stars.push_back(z);
-    // Color
-    stars.push_back(1.0f);
-    stars.push_back(1.0f);
-    stars.push_back(1.0f);
-  }
-  //Load stored values in a model object and write those in buffer
-  model star_model = {stars, model::POSITION | model::NORMAL};
-  // generate vertex array object
+  //Stars are generated in the vertex shader from their index and the seed,
+  //so the vertex array needs no buffers at all
   glGenVertexArrays(1, &m_obj_star.vertex_AO);
-  // bind the array for attaching buffers
   glBindVertexArray(m_obj_star.vertex_AO);
 
-  // generate generic buffer
-  glGenBuffers(1, &m_obj_star.vertex_BO);
-  // bind this as an vertex array buffer containing all attributes
-  glBindBuffer(GL_ARRAY_BUFFER, m_obj_star.vertex_BO);
-  // configure currently bound array buffer
-  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * star_model.data.size(), star_model.data.data(), GL_STATIC_DRAW);
-
-  // activate first attribute on gpu
-  glEnableVertexAttribArray(0);
-  // first attribute is 3 floats with no offset & stride
-  glVertexAttribPointer(0, model::POSITION.components, (gl::GLenum) model::POSITION.type, GL_FALSE, star_model.vertex_bytes, star_model.offsets[model::POSITION]);
-  // activate second attribute on gpu
-  glEnableVertexAttribArray(1);
-  // second attribute is 3 floats with no offset & stride
-  glVertexAttribPointer(1, model::NORMAL.components, (gl::GLenum) model::NORMAL.type, GL_FALSE, star_model.vertex_bytes, star_model.offsets[model::NORMAL]);
-
-   // generate generic buffer
-  glGenBuffers(1, &m_obj_star.element_BO);
-  // bind this as an vertex array buffer containing all attributes
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_obj_star.element_BO);
-  // configure currently bound array buffer
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, model::INDEX.size * star_model.indices.size(), star_model.indices.data(), GL_STATIC_DRAW);
-  
+  //Stars lie in a shell around the sun
+  star_bounds_center = glm::fvec3{0.0f};
+  star_bounds_radius = star_max_distance;
 }
 void ApplicationSolar::initializeRenderBuffer(GLsizei width, GLsizei height){
     glGenRenderbuffers(1, &rb_handle);
@@ -671,6 +895,9 @@ void ApplicationSolar::initializeRenderBuffer(GLsizei width, GLsizei height){
       width,
       height
     );
+    MEMORY_TRACK(renderbuffer, rb_handle,
+                 memory_tracker::texture_bytes(GL_DEPTH_COMPONENT24, std::size_t(width), std::size_t(height)),
+                 "offscreen depth");
 }
 void ApplicationSolar::initializeFrameBuffers(GLsizei width, GLsizei height){
     glGenTextures(1, &screen_quad_texture.obj_ptr);
@@ -680,8 +907,13 @@ void ApplicationSolar::initializeFrameBuffers(GLsizei width, GLsizei height){
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GLint(GL_LINEAR));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GLint(GL_LINEAR));
     glTexImage2D(GL_TEXTURE_2D, 0, GLint(GL_RGBA8), width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+    MEMORY_TRACK(texture, screen_quad_texture.obj_ptr,
+                 memory_tracker::texture_bytes(GL_RGBA8, std::size_t(width), std::size_t(height)),
+                 "offscreen color");
   
     glGenFramebuffers(1, &fbo_handle);
+    // attachments are accounted separately
+    MEMORY_TRACK(framebuffer, fbo_handle, 0, "offscreen framebuffer");
     glBindFramebuffer(GL_FRAMEBUFFER, fbo_handle);
   
     glFramebufferTexture(
@@ -733,6 +965,7 @@ void ApplicationSolar::initializeScreenQuadGeometry(){
     glBindBuffer(GL_ARRAY_BUFFER, screen_quad_object.vertex_BO);
     // configure currently bound array buffer
     glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(GLsizei(sizeof(float) * vertices.size())), vertices.data(), GL_STATIC_DRAW);
+    MEMORY_TRACK(buffer, screen_quad_object.vertex_BO, sizeof(float) * vertices.size(), "screen quad geometry");
   
     // activate first attribute on gpu
     glEnableVertexAttribArray(0);
@@ -749,13 +982,34 @@ void ApplicationSolar::initializeScreenQuadGeometry(){
     std::cout << "Initialized!" << std::endl;
 }
 
+// delete buffers and vertex array of a model object
+void delete_model_object(model_object const& object) {
+  glDeleteBuffers(1, &object.vertex_BO);
+  MEMORY_RELEASE(buffer, object.vertex_BO);
+  glDeleteBuffers(1, &object.element_BO);
+  MEMORY_RELEASE(buffer, object.element_BO);
+  glDeleteVertexArrays(1, &object.vertex_AO);
+}
+
+
 ApplicationSolar::~ApplicationSolar() {
-  glDeleteBuffers(1, &m_obj_planet.vertex_BO);
-  glDeleteBuffers(1, &m_obj_planet.element_BO);
-  glDeleteVertexArrays(1, &m_obj_planet.vertex_AO);
-  glDeleteBuffers(1, &m_obj_star.vertex_BO);
-  glDeleteBuffers(1, &m_obj_star.element_BO);
-  glDeleteVertexArrays(1, &m_obj_star.vertex_AO);
+  delete_model_object(m_obj_star);
+  glDeleteTextures(1, &body_texture_array);
+  MEMORY_RELEASE(texture, body_texture_array);
+  glDeleteTextures(1, &skydome_texture.tex_obj);
+  MEMORY_RELEASE(texture, skydome_texture.tex_obj);
+  glDeleteTextures(1, &draw_parameter_texture);
+
+  glDeleteBuffers(1, &screen_quad_object.vertex_BO);
+  MEMORY_RELEASE(buffer, screen_quad_object.vertex_BO);
+  glDeleteVertexArrays(1, &screen_quad_object.vertex_AO);
+
+  glDeleteFramebuffers(1, &fbo_handle);
+  MEMORY_RELEASE(framebuffer, fbo_handle);
+  glDeleteTextures(1, &screen_quad_texture.obj_ptr);
+  MEMORY_RELEASE(texture, screen_quad_texture.obj_ptr);
+  glDeleteRenderbuffers(1, &rb_handle);
+  MEMORY_RELEASE(renderbuffer, rb_handle);
 }
 
 // exe entry point
@@ -0,0 +1,284 @@
+// microbenchmarks of the cpu paths of the framework
+// usage: framework_bench [resource_path] [repetitions]
+#include "chunked_mesh.hpp"
+#include "model.hpp"
+#include "model_loader.hpp"
+#include "procedural_mesh.hpp"
+#include "texture_loader.hpp"
+#include "utils.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// keeps results alive so the optimizer cannot remove benchmarked work
+volatile std::size_t sink = 0;
+
+// heap usage of the whole process, every allocation stores its size in front,
+// atomic since worker threads of the benchmarked code allocate and free too
+std::atomic<std::size_t> heap_allocations{0};
+std::atomic<std::size_t> heap_bytes{0};
+std::atomic<std::size_t> heap_peak_bytes{0};
+const std::size_t heap_header = 16;
+
+void* operator new(std::size_t bytes) {
+  char* memory = static_cast<char*>(std::malloc(bytes + heap_header));
+  if (!memory) {
+    throw std::bad_alloc{};
+  }
+  *reinterpret_cast<std::size_t*>(memory) = bytes;
+  ++heap_allocations;
+  std::size_t current = heap_bytes += bytes;
+  std::size_t peak = heap_peak_bytes.load();
+  while (peak < current && !heap_peak_bytes.compare_exchange_weak(peak, current)) {}
+  return memory + heap_header;
+}
+
+void operator delete(void* pointer) noexcept {
+  if (pointer) {
+    char* memory = reinterpret_cast<char*>(reinterpret_cast<std::uintptr_t>(pointer) - heap_header);
+    heap_bytes -= *reinterpret_cast<std::size_t*>(memory);
+    std::free(memory);
+  }
+}
+
+// print allocations and peak heap growth caused by function
+void count_allocations(std::string const& name, std::function<void()> const& function) {
+  std::size_t allocations = heap_allocations;
+  std::size_t bytes = heap_bytes;
+  heap_peak_bytes = bytes;
+  function();
+  std::cout << std::left << std::setw(32) << name << std::right
+            << std::setw(12) << heap_allocations - allocations
+            << std::setw(12) << (heap_peak_bytes - bytes) / 1024 << std::endl;
+}
+
+// run function warmup times, then measure each repetition separately
+void benchmark(std::string const& name, unsigned repetitions, std::function<void()> const& function) {
+  const unsigned warmup = std::max(1u, repetitions / 10);
+  for (unsigned i = 0; i < warmup; ++i) {
+    function();
+  }
+
+  std::vector<double> times(repetitions);
+  for (auto& time : times) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+    time = std::chrono::duration<double, std::micro>(end - start).count();
+  }
+
+  std::sort(times.begin(), times.end());
+  double mean = 0.0;
+  for (double time : times) {
+    mean += time;
+  }
+  mean /= double(times.size());
+  double variance = 0.0;
+  for (double time : times) {
+    variance += (time - mean) * (time - mean);
+  }
+  double stddev = std::sqrt(variance / double(times.size()));
+
+  std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(12) << times.front()
+            << std::setw(12) << times[times.size() / 2]
+            << std::setw(12) << mean
+            << std::setw(12) << stddev
+            << std::setw(12) << times.back() << std::endl;
+}
+
+// write a subdivided grid with positions, normals and texcoords as obj
+void write_grid_obj(std::string const& path, unsigned resolution) {
+  std::ofstream file{path};
+  for (unsigned y = 0; y <= resolution; ++y) {
+    for (unsigned x = 0; x <= resolution; ++x) {
+      float u = float(x) / float(resolution);
+      float v = float(y) / float(resolution);
+      file << "v " << u << " " << v << " " << std::sin(u * 6.0f) * 0.1f << "\n";
+      file << "vn 0 0 1\n";
+      file << "vt " << u << " " << v << "\n";
+    }
+  }
+  for (unsigned y = 0; y < resolution; ++y) {
+    for (unsigned x = 0; x < resolution; ++x) {
+      // obj indices start at one
+      unsigned i = y * (resolution + 1) + x + 1;
+      unsigned j = i + resolution + 1;
+      file << "f " << i << "/" << i << "/" << i << " " << i + 1 << "/" << i + 1 << "/" << i + 1
+           << " " << j << "/" << j << "/" << j << "\n";
+      file << "f " << i + 1 << "/" << i + 1 << "/" << i + 1 << " " << j + 1 << "/" << j + 1 << "/" << j + 1
+           << " " << j << "/" << j << "/" << j << "\n";
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  std::string resource_path{};
+  if (argc > 1) {
+    resource_path = argv[1];
+  }
+  else {
+    std::string exe_path{argv[0]};
+    resource_path = exe_path.substr(0, exe_path.find_last_of("/\\"));
+    resource_path += "/../../resources/";
+  }
+  unsigned repetitions = 50u;
+  if (argc > 2) {
+    // statistics need at least one measurement
+    std::string value{argv[2]};
+    std::size_t parsed = 0;
+    unsigned long number = 0;
+    try {
+      number = std::stoul(value, &parsed);
+    }
+    // invalid_argument and out_of_range
+    catch (std::logic_error const&) {
+      parsed = 0;
+    }
+    if (parsed == 0 || parsed != value.size() || value[0] == '-' || number == 0
+        || number > std::numeric_limits<unsigned>::max()) {
+      std::cerr << "invalid repetitions '" << value << "', expected a positive number" << std::endl
+                << "usage: " << argv[0] << " [resource_path] [repetitions]" << std::endl;
+      return EXIT_FAILURE;
+    }
+    repetitions = unsigned(number);
+  }
+
+  std::string const small_obj = resource_path + "models/sphere.obj";
+  std::string const large_obj = "framework_bench_grid.obj";
+  write_grid_obj(large_obj, 512);
+
+  std::cout << std::left << std::setw(32) << "benchmark [us]" << std::right
+            << std::setw(12) << "min" << std::setw(12) << "median" << std::setw(12) << "mean"
+            << std::setw(12) << "stddev" << std::setw(12) << "max" << std::endl;
+
+  benchmark("model_loader::obj small", repetitions, [&]() {
+    model m = model_loader::obj(small_obj, model::NORMAL | model::TEXCOORD);
+    sink = sink + m.data.size();
+  });
+
+  benchmark("model_loader::obj large", std::max(1u, repetitions / 10), [&]() {
+    model m = model_loader::obj(large_obj, model::NORMAL | model::TEXCOORD);
+    sink = sink + m.data.size();
+  });
+
+  benchmark("model_loader::obj_arena small", repetitions, [&]() {
+    model m = model_loader::obj_arena(small_obj, model::NORMAL | model::TEXCOORD);
+    sink = sink + m.data.size();
+  });
+
+  benchmark("model_loader::obj_arena large", std::max(1u, repetitions / 10), [&]() {
+    model m = model_loader::obj_arena(large_obj, model::NORMAL | model::TEXCOORD);
+    sink = sink + m.data.size();
+  });
+
+  // binary gltf with two primitives, quantized normals and half float texcoords
+  benchmark("model_loader::gltf small", repetitions, [&]() {
+    model m = model_loader::gltf(resource_path + "models/cube.glb", model::NORMAL | model::TEXCOORD);
+    sink = sink + m.data.size() + m.submeshes.size();
+  });
+
+  // chunks are read straight from the mapping, like uploads do
+  std::string const large_chunks = "framework_bench_grid.chunks";
+  chunked_mesh::write(large_chunks, model_loader::obj_arena(large_obj, model::NORMAL | model::TEXCOORD));
+  auto read_chunks = [&]() {
+    chunked_mesh mesh{large_chunks};
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < mesh.chunk_count(); ++i) {
+      GLuint const* indices = mesh.indices(i);
+      for (std::size_t j = 0; j < mesh.chunk(i).index_count; ++j) {
+        sum += indices[j];
+      }
+      mesh.evict(i);
+    }
+    sink = sink + sum;
+  };
+  benchmark("chunked_mesh large", std::max(1u, repetitions / 10), read_chunks);
+
+  // sphere levels as generated at startup and a large level split across threads
+  for (unsigned level : {3u, 7u}) {
+    unsigned runs = level < 5 ? repetitions : std::max(1u, repetitions / 10);
+    benchmark("procedural_mesh::uv_sphere " + std::to_string(level), runs, [&]() {
+      model m = procedural_mesh::uv_sphere(level, model::NORMAL | model::TEXCOORD);
+      sink = sink + m.data.size();
+    });
+    benchmark("procedural_mesh::icosphere " + std::to_string(level), runs, [&]() {
+      model m = procedural_mesh::icosphere(level, model::NORMAL);
+      sink = sink + m.data.size();
+    });
+  }
+
+  benchmark("texture_loader::file", repetitions, [&]() {
+    pixel_data texture = texture_loader::file(resource_path + "textures/earth.png");
+    sink = sink + texture.pixels.size();
+  });
+
+  model const sphere = model_loader::obj(small_obj, model::NORMAL | model::TEXCOORD);
+  benchmark("model offsets", repetitions * 100, [&]() {
+    std::vector<GLfloat> vertex(8, 0.0f);
+    model m{vertex, model::POSITION | model::NORMAL | model::TEXCOORD};
+    sink = sink + std::size_t(m.vertex_bytes);
+  });
+
+  benchmark("model construction sphere", repetitions, [&]() {
+    model m{sphere.data, model::POSITION | model::NORMAL | model::TEXCOORD, sphere.indices};
+    sink = sink + m.vertex_num;
+  });
+
+  benchmark("utils::read_file", repetitions, [&]() {
+    sink = sink + utils::read_file(small_obj).size();
+  });
+
+  // shader_loader has no entry, besides utils::read_file above it only
+  // issues gl calls, which need a context
+
+  // model and normal matrix computation of the solar system per body
+  glm::fmat4 const view_transform = glm::translate(glm::fmat4{}, glm::fvec3{0.0f, 0.0f, 40.0f});
+  benchmark("body matrices x1000", repetitions, [&]() {
+    float sum = 0.0f;
+    for (unsigned i = 0; i < 1000; ++i) {
+      glm::fmat4 size = glm::scale(glm::mat4{}, glm::vec3{1.0f + float(i % 7)});
+      glm::fmat4 model_matrix = glm::rotate(size, float(i) * 0.01f, glm::fvec3{0.0f, 1.0f, 0.0f});
+      model_matrix = glm::translate(model_matrix, glm::fvec3{0.0f, 0.0f, -float(i % 20)});
+      glm::fmat4 normal_matrix = glm::inverseTranspose(glm::inverse(view_transform) * model_matrix);
+      sum += normal_matrix[0][0];
+    }
+    sink = sink + std::size_t(sum);
+  });
+
+  std::cout << std::endl << std::left << std::setw(32) << "heap usage" << std::right
+            << std::setw(12) << "allocations" << std::setw(12) << "peak [KiB]" << std::endl;
+  count_allocations("model_loader::obj large", [&]() {
+    model m = model_loader::obj(large_obj, model::NORMAL | model::TEXCOORD);
+    sink = sink + m.data.size();
+  });
+  model_loader::load_stats stats;
+  count_allocations("model_loader::obj_arena large", [&]() {
+    model m = model_loader::obj_arena(large_obj, model::NORMAL | model::TEXCOORD, &stats);
+    sink = sink + m.data.size();
+  });
+  std::cout << std::left << std::setw(32) << "  reported by loader" << std::right
+            << std::setw(12) << stats.allocations << std::setw(12) << stats.peak_bytes / 1024 << std::endl;
+  count_allocations("chunked_mesh large", read_chunks);
+
+  std::remove(large_obj.c_str());
+  std::remove(large_chunks.c_str());
+  return 0;
+}
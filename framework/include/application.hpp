@@ -3,6 +3,7 @@
 
 #include "structs.hpp"
 #include "launcher.hpp"
+#include "profiler.hpp"
 
 
 #include <glm/gtc/type_precision.hpp>
@@ -24,8 +25,24 @@ class Application {
   virtual void updateProjection() = 0;
   // react to key input
   inline virtual void keyCallback(int key, int scancode, int action, int mods) {};
+  // advance simulation by fixed timestep in seconds
+  inline virtual void update(double timestep) {};
+  // prepare everything render needs, e.g. transforms and culling
+  // runs on the simulation thread if concurrentUpdate returns true
+  inline virtual void prepareFrame() {};
+  // whether update and prepareFrame only share state with render through
+  // thread safe buffers and may run concurrently to it
+  inline virtual bool concurrentUpdate() const { return false; };
+  // whether assets are still streamed in and frames show placeholders
+  inline virtual bool loading() const { return false; };
+  // set blend factor between previous and current simulation state
+  void setInterpolation(float alpha);
+  // disable behaviour depending on wall clock time, for benchmarks
+  void setDeterministic(bool deterministic);
   // 
   virtual std::map<std::string, shader_program>& getShaderPrograms();
+  // cpu and gpu timings of render passes
+  profiler& getProfiler();
 
   virtual void render() const = 0;
 
@@ -38,8 +55,16 @@ class Application {
   glm::fmat4 m_view_transform;
   glm::fmat4 m_view_projection;
 
+  // blend factor for rendering between last two simulation states
+  float m_interpolation;
+  // output must not depend on wall clock time
+  bool m_deterministic;
+
   // container for the shader programs
   std::map<std::string, shader_program> m_shaders{};
+
+  // passes are timed during const rendering
+  mutable profiler m_profiler;
 };
 
 #endif
\ No newline at end of file
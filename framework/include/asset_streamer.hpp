@@ -0,0 +1,58 @@
+#ifndef ASSET_STREAMER_HPP
+#define ASSET_STREAMER_HPP
+
+#include "model.hpp"
+#include "pixel_data.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// decodes textures and models on worker threads, finished assets are
+// handed to their callbacks on the gl thread by poll
+class asset_streamer {
+ public:
+  // number of worker threads, zero to choose from the hardware
+  asset_streamer(unsigned num_threads = 0);
+  // drops unfinished requests
+  ~asset_streamer();
+
+  // load image file, on_ready receives the pixels during poll
+  void request_texture(std::string const& path, std::function<void(pixel_data&)> on_ready);
+  // load obj or gltf file by extension, on_ready receives the model during poll
+  void request_model(std::string const& path, model::attrib_flag_t attribs, std::function<void(model&)> on_ready);
+
+  // run callbacks of at most max_assets finished requests, call between frames
+  std::size_t poll(std::size_t max_assets = std::size_t(-1));
+  // number of requests whose callbacks have not run yet
+  std::size_t pending() const;
+
+ private:
+  // work run on the gl thread once the asset is loaded
+  typedef std::function<void()> completion;
+  // decoding run on a worker, returns the upload step
+  struct job {
+    std::string path;
+    // name of the startup phase the loading is accounted to
+    std::string phase;
+    std::function<completion()> load;
+  };
+
+  void enqueue(std::string const& path, std::string const& phase, std::function<completion()> load);
+  void work();
+
+  std::vector<std::thread> m_workers;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::deque<job> m_requests;
+  std::deque<completion> m_finished;
+  std::size_t m_pending;
+  bool m_running;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef CHUNKED_MESH_HPP
+#define CHUNKED_MESH_HPP
+
+#include "geometry_pool.hpp"
+#include "mapped_file.hpp"
+#include "model.hpp"
+
+#include <glbinding/gl/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// use gl definitions from glbinding
+using namespace gl;
+
+// self contained part of a chunked mesh, indices address only its own vertices
+struct mesh_chunk {
+  // byte offsets of the data in the file
+  std::uint64_t vertex_offset;
+  std::uint64_t index_offset;
+  std::uint32_t vertex_count;
+  std::uint32_t index_count;
+  // bounding sphere of the chunk
+  float center[3];
+  float radius;
+};
+
+// mesh stored as spatially ordered chunks in a memory mapped file,
+// chunks are copied from the mapping into buffers one at a time, so
+// resident memory is bounded by the chunks in flight instead of the model
+class chunked_mesh {
+ public:
+  // map the file, throws if it is no valid chunked mesh
+  explicit chunked_mesh(std::string const& path);
+
+  // split mesh into chunks of at most chunk_triangles neighbouring triangles,
+  // chunks follow a morton curve through the mesh bounds
+  static void write(std::string const& path, model const& mesh, std::size_t chunk_triangles = 1 << 15);
+
+  model::attrib_flag_t attributes() const;
+  GLsizei vertex_bytes() const;
+  std::uint64_t vertex_total() const;
+  std::uint64_t index_total() const;
+
+  std::size_t chunk_count() const;
+  mesh_chunk const& chunk(std::size_t index) const;
+  // data of a chunk inside the mapping
+  void const* vertices(std::size_t index) const;
+  GLuint const* indices(std::size_t index) const;
+  // allow the system to drop the pages of a chunk, they are read again on access
+  void evict(std::size_t index) const;
+
+  // copy following chunks into the pool until budget_bytes are uploaded,
+  // but at least one, and append their ranges in chunk order
+  // returns whether chunks remain, the pool must use the layout of the file
+  // throws before uploading a chunk whose indices exceed its vertices
+  bool upload_next(geometry_pool& pool, std::size_t budget_bytes, std::vector<mesh_range>& ranges);
+  // chunks uploaded so far
+  std::size_t uploaded() const;
+
+ private:
+  std::string m_path;
+  mapped_file m_file;
+
+  model::attrib_flag_t m_attributes;
+  GLsizei m_vertex_bytes;
+  std::uint64_t m_vertex_total;
+  std::uint64_t m_index_total;
+  mesh_chunk const* m_chunks;
+  std::size_t m_chunk_count;
+  std::size_t m_uploaded;
+};
+
+#endif
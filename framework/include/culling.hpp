@@ -0,0 +1,96 @@
+#ifndef CULLING_HPP
+#define CULLING_HPP
+
+#include "meshlet.hpp"
+
+#include <glm/gtc/type_precision.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// bounding spheres stored as structure of arrays for simd testing
+struct sphere_set {
+  void add(glm::fvec3 const& center, float radius);
+  void clear();
+  std::size_t size() const;
+
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<float> radius;
+};
+
+// results of the last culling pass
+struct culling_stats {
+  std::size_t tested = 0;
+  std::size_t visible = 0;
+  // outside of the view frustum
+  std::size_t frustum_culled = 0;
+  // inside the frustum, but projected smaller than the threshold
+  std::size_t size_culled = 0;
+};
+
+// meshlets tested by all cull_meshlets calls since the last update
+struct meshlet_stats {
+  std::size_t tested = 0;
+  std::size_t visible = 0;
+  std::size_t frustum_culled = 0;
+  std::size_t size_culled = 0;
+  // all triangles face away from the camera
+  std::size_t backface_culled = 0;
+  // triangles of tested and visible meshlets
+  std::size_t triangles_tested = 0;
+  std::size_t triangles_visible = 0;
+};
+
+// contiguous range of an index buffer, counted in indices
+struct index_range {
+  std::size_t offset;
+  std::size_t count;
+};
+
+// tests bounding spheres against view frustum and projected size
+class frustum_culler {
+ public:
+  // minimal projected diameter in pixels of visible objects
+  frustum_culler(float min_pixel_size = 1.0f);
+
+  // extract frustum planes, viewport height is needed for projected size
+  void update(glm::fmat4 const& view_matrix, glm::fmat4 const& projection_matrix, float viewport_height);
+  // write one visibility flag per sphere, returns number of visible spheres
+  std::size_t cull(sphere_set const& spheres, std::vector<std::uint8_t>& visible);
+  // append index ranges of meshlets that are inside the frustum and face the camera,
+  // ranges adjacent in the index buffer are merged, returns number of visible meshlets
+  // model matrix may only rotate, translate and scale uniformly
+  std::size_t cull_meshlets(std::vector<meshlet> const& meshlets, glm::fmat4 const& model_matrix,
+                            std::vector<index_range>& visible);
+  // projected diameter in pixels of a sphere, unbounded if the camera is inside
+  float projected_size(glm::fvec3 const& center, float radius) const;
+
+  culling_stats const& stats() const;
+  meshlet_stats const& meshlet_statistics() const;
+
+  float min_pixel_size;
+
+ private:
+  // flag spheres outside the frustum or too small and count them in stats
+  void test(sphere_set const& spheres, std::vector<std::uint8_t>& visible, culling_stats& stats) const;
+
+  // left, right, bottom, top, near, far plane as normalized (a, b, c, d)
+  glm::fvec4 m_planes[6];
+  // row of the view projection matrix yielding clip space w
+  glm::fvec4 m_w_row;
+  // projected diameter in pixels of a sphere with radius 1 at w = 1
+  float m_pixel_scale;
+
+  // camera position in world space
+  glm::fvec3 m_eye;
+
+  culling_stats m_stats;
+  meshlet_stats m_meshlet_stats;
+  // world space bounds of the meshlets of one object
+  sphere_set m_meshlet_bounds;
+  std::vector<std::uint8_t> m_meshlet_visible;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef DRAW_BATCH_HPP
+#define DRAW_BATCH_HPP
+
+#include "geometry_pool.hpp"
+#include "stream_buffer.hpp"
+#include "submesh.hpp"
+
+#include <glbinding/gl/types.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// use gl definitions from glbinding
+using namespace gl;
+
+// DrawElementsIndirectCommand as read from the indirect buffer
+struct draw_elements_command {
+  GLuint count;
+  GLuint instance_count;
+  GLuint first_index;
+  GLint base_vertex;
+  GLuint base_instance;
+};
+
+// collects draws of meshes from one geometry_pool and submits them together,
+// every draw receives an unsigned draw id attribute to fetch its parameters, by default its index
+// a single glMultiDrawElementsIndirect is used if ARB_multi_draw_indirect is available,
+// otherwise one glDrawElementsBaseVertex per draw with the id as constant attribute
+class draw_batch {
+ public:
+  draw_batch(geometry_pool const& pool, GLuint draw_id_location, std::string const& owner, std::size_t capacity = 256);
+  ~draw_batch();
+
+  draw_batch(draw_batch const&) = delete;
+  draw_batch& operator=(draw_batch const&) = delete;
+
+  // remove all draws
+  void clear();
+  // append draw of a mesh, returns its draw id
+  GLuint add(mesh_range const& range);
+  // append draw of a mesh with given draw id, draws may share an id
+  void add(mesh_range const& range, GLuint draw_id);
+  // append one draw per submesh of a pooled mesh, each with draw id first_id plus
+  // its material, so parameters switch at material boundaries inside the batch
+  void add(mesh_range const& mesh, std::vector<submesh> const& submeshes, GLuint first_id);
+  std::size_t size() const;
+
+  // draw everything added since the last clear with the vertex array of the pool,
+  // indirect commands are written to the frame region of the stream
+  void submit(stream_buffer& stream);
+
+  // whether draws are submitted indirectly
+  bool indirect() const;
+
+ private:
+  // grow draw id buffer
+  void reserve(std::size_t draws);
+
+  geometry_pool const& m_pool;
+  GLuint m_draw_id_location;
+  std::string m_owner;
+  bool m_indirect;
+
+  std::vector<draw_elements_command> m_commands;
+  std::size_t m_capacity;
+  // holds 0 to capacity - 1, read once per instance
+  GLuint m_draw_id_buffer;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef GEOMETRY_POOL_HPP
+#define GEOMETRY_POOL_HPP
+
+#include "model.hpp"
+
+#include <glbinding/gl/types.h>
+
+#include <cstddef>
+#include <string>
+
+// use gl definitions from glbinding
+using namespace gl;
+
+// location of a mesh inside a geometry_pool
+struct mesh_range {
+  // number of indices to draw
+  GLsizei index_count = 0;
+  // byte offset of the first index in the shared index buffer
+  std::size_t index_offset = 0;
+  // added to every index to address the shared vertex buffer
+  GLint base_vertex = 0;
+};
+
+// part of a mesh given by a range of its indices, like a submesh or meshlet
+mesh_range sub_range(mesh_range const& mesh, std::size_t first_index, std::size_t index_count);
+
+// suballocates meshes of one vertex layout from a single vertex and index
+// buffer, all of them are drawn from the same vertex array object
+class geometry_pool {
+ public:
+  // Layout is a vertex_layout, capacities are counted in vertices and indices
+  template<typename Layout>
+  geometry_pool(Layout, std::string const& owner, std::size_t vertex_capacity = 1 << 16, std::size_t index_capacity = 1 << 18)
+   :geometry_pool{Layout::stride, &Layout::setup_attributes, &Layout::check, owner, vertex_capacity, index_capacity}
+  {}
+  ~geometry_pool();
+
+  geometry_pool(geometry_pool const&) = delete;
+  geometry_pool& operator=(geometry_pool const&) = delete;
+
+  // copy mesh into the shared buffers, grows them if required
+  // space is never reused, replaced meshes keep their old range allocated
+  mesh_range allocate(model const& mesh);
+  // copy vertices already in the layout of the pool, like chunks of a mapped file
+  mesh_range allocate(void const* vertices, std::size_t vertex_count, GLuint const* indices, std::size_t index_count);
+
+  // bind the shared vertex array object
+  void bind() const;
+  // draw triangles of a mesh, the pool must be bound
+  void draw(mesh_range const& range) const;
+
+  // bytes per vertex of the layout
+  GLsizei stride() const;
+  GLuint vertex_array() const;
+  GLuint vertex_buffer() const;
+  GLuint index_buffer() const;
+  // allocated vertices and indices
+  std::size_t vertex_count() const;
+  std::size_t index_count() const;
+
+ private:
+  geometry_pool(GLsizei stride, void (*setup_attributes)(), void (*check)(model const&),
+                std::string const& owner, std::size_t vertex_capacity, std::size_t index_capacity);
+
+  // grow buffers to hold at least the given number of vertices and indices
+  void reserve(std::size_t vertices, std::size_t indices);
+  // replace buffer by a larger one keeping the used bytes
+  GLuint grow_buffer(GLuint old_buffer, std::size_t used_bytes, std::size_t new_bytes);
+
+  GLsizei m_stride;
+  void (*m_setup_attributes)();
+  void (*m_check)(model const&);
+  std::string m_owner;
+
+  GLuint m_vertex_array;
+  GLuint m_vertex_buffer;
+  GLuint m_index_buffer;
+  std::size_t m_vertex_capacity;
+  std::size_t m_index_capacity;
+  std::size_t m_vertex_count;
+  std::size_t m_index_count;
+};
+
+#endif
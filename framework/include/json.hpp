@@ -0,0 +1,43 @@
+#ifndef JSON_HPP
+#define JSON_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace json {
+
+// parsed json document node, missing members and elements read as null
+struct value {
+  enum kind_t {null_kind, bool_kind, number_kind, string_kind, array_kind, object_kind};
+
+  kind_t kind = null_kind;
+  bool boolean = false;
+  double number = 0.0;
+  std::string string;
+  // elements of arrays, values of objects, held by pointer
+  // since a vector of the incomplete value type is not allowed
+  std::vector<std::unique_ptr<value>> elements;
+  // member names of objects, in order of the values
+  std::vector<std::string> keys;
+
+  bool is_null() const;
+  // member with name or null
+  value const& operator[](std::string const& key) const;
+  // element at index or null
+  value const& operator[](std::size_t index) const;
+  // number of elements or members
+  std::size_t size() const;
+
+  // value if it has the kind, otherwise the fallback
+  double number_or(double fallback) const;
+  std::string string_or(std::string const& fallback) const;
+};
+
+// throws logic_error on malformed text
+value parse(std::string const& text);
+
+}
+
+#endif
@@ -2,8 +2,13 @@
 #define LAUNCHER_HPP
 
 #include "application.hpp"
+#include "startup.hpp"
 
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 // forward declarations
 class Application;
@@ -27,21 +32,40 @@ class Launcher {
   void run(){
     initialize();
 
-    m_application = new T{m_resource_path};
+    {
+      startup::phase phase{"application construction"};
+      m_application = new T{m_resource_path};
+    }
 
-    mainLoop();
+    runLoop();
   }
   
   // create window and set callbacks
   void initialize();
+  // compile shaders and set initial gl state
+  void initialize_rendering();
+  // select and start loop matching options and application
+  void runLoop();
   // start main loop
   void mainLoop();
+  // main loop preparing frame N+1 on the simulation thread while rendering frame N
+  void threadedLoop();
+  // simulation thread function, prepares a frame whenever requested
+  void simulationLoop();
+  // render fixed number of frames with fixed timestep and print stats
+  void benchmarkLoop();
+  // print frame time percentiles and pass stats as json
+  void print_benchmark_results(std::vector<double> frame_times) const;
+  // run as many fixed simulation steps as elapsed since last frame
+  void update_simulation();
   // update viewport and field of view
   void update_projection(GLFWwindow* window, int width, int height);
   // load shader programs and update uniform locations
   void update_shader_programs(bool throwing);
   // handle key input
   void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+  // record startup milestones, print report once everything is loaded
+  void track_startup();
   // calculate fps and show in window title
   void show_fps();
   // free resources
@@ -56,10 +80,35 @@ class Launcher {
   // the rendering window
   GLFWwindow* m_window;
 
+  // number of frames to render headless, interactive if zero
+  const unsigned m_benchmark_frames;
+  // run simulation on own thread if application supports it
+  const bool m_threaded;
+
+  // simulation thread and its synchronisation with the render thread
+  std::thread m_simulation_thread;
+  std::mutex m_frame_mutex;
+  std::condition_variable m_frame_condition;
+  bool m_frame_requested;
+  bool m_frame_prepared;
+  bool m_simulation_running;
+
+  // duration of one simulation step in seconds
+  const double m_update_timestep;
+  // upper bound of simulation steps per frame, prevents spiral of death
+  const unsigned m_max_updates_per_frame;
+  // time not yet consumed by simulation steps
+  double m_update_accumulator;
+  double m_last_frame_time;
+
   // variables for fps computation
   double m_last_second_time;
   unsigned m_frames_per_second;
 
+  // startup milestones reached
+  bool m_first_frame_shown;
+  bool m_startup_reported;
+
   // path to the resource folders
   std::string m_resource_path;
 
@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstdint>
+#include <string>
+
+// read only memory mapping of a whole file, pages are loaded on first access
+class mapped_file {
+ public:
+  // throws if the file can not be opened or is empty
+  explicit mapped_file(std::string const& path);
+  ~mapped_file();
+
+  mapped_file(mapped_file const&) = delete;
+  mapped_file& operator=(mapped_file const&) = delete;
+
+  unsigned char const* data() const;
+  std::uint64_t size() const;
+  // allow the system to drop the pages inside the range, they are read again on access
+  void evict(std::uint64_t offset, std::uint64_t bytes) const;
+
+ private:
+  // unmap and close the file
+  void unmap();
+
+  unsigned char const* m_data;
+  std::uint64_t m_size;
+#ifdef _WIN32
+  void* m_file;
+  void* m_mapping;
+#else
+  int m_file;
+#endif
+};
+
+#endif
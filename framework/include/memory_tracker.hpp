@@ -0,0 +1,62 @@
+#ifndef MEMORY_TRACKER_HPP
+#define MEMORY_TRACKER_HPP
+
+#include <glbinding/gl/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// use gl definitions from glbinding
+using namespace gl;
+
+// accounts estimated sizes of gpu objects and large host allocations,
+// resources are identified by type and handle or address
+namespace memory_tracker {
+  enum resource_type {
+    buffer,
+    texture,
+    renderbuffer,
+    framebuffer,
+    // cpu copies of asset data, e.g. decoded images awaiting upload
+    host,
+    num_resource_types
+  };
+
+  struct totals {
+    std::size_t live_bytes;
+    std::size_t live_count;
+    // largest number of live bytes at any time
+    std::size_t peak_bytes;
+  };
+
+  // register resource or update its size after reallocation, use MEMORY_TRACK
+  void track(resource_type type, std::uintptr_t id, std::size_t bytes,
+             std::string const& owner, char const* file, int line);
+  // unregister resource, unknown ids are ignored
+  void release(resource_type type, std::uintptr_t id);
+
+  // totals over all types or of a single type
+  totals total();
+  totals total(resource_type type);
+  char const* type_name(resource_type type);
+
+  // table of live totals and peaks per type
+  void print(std::ostream& os);
+  // totals per type as json object
+  void print_json(std::ostream& os);
+  // list all live resources with owner and creation site, returns their number
+  std::size_t print_leaks(std::ostream& os);
+
+  // estimated size of a texture image, mipmap chains add a third
+  std::size_t texture_bytes(GLenum internal_format, std::size_t width, std::size_t height, bool mipmaps = false);
+};
+
+// records the calling source location as creation site
+#define MEMORY_TRACK(type, id, bytes, owner) \
+  memory_tracker::track(memory_tracker::type, std::uintptr_t(id), bytes, owner, __FILE__, __LINE__)
+#define MEMORY_RELEASE(type, id) \
+  memory_tracker::release(memory_tracker::type, std::uintptr_t(id))
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef MESHLET_HPP
+#define MESHLET_HPP
+
+#include <glm/gtc/type_precision.hpp>
+
+#include <cstddef>
+
+// small cluster of neighbouring triangles, culled as a whole
+struct meshlet {
+  // bounding sphere in model space
+  glm::fvec3 center;
+  float radius;
+  // normal cone, every triangle faces away from an eye at the position e
+  // if dot(center - e, cone_axis) >= cone_cutoff * length(center - e) + radius
+  glm::fvec3 cone_axis;
+  // sine of the cone spread, 1 if the cluster can not be backface culled
+  float cone_cutoff;
+  // triangles as range in the indices of the model
+  std::size_t index_offset;
+  std::size_t index_count;
+};
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef MODEL_HPP
 #define MODEL_HPP
 
+#include "meshlet.hpp"
+#include "submesh.hpp"
+
 #include <glbinding/gl/types.h>
 
 #include <map>
@@ -53,6 +56,8 @@ struct model {
   
   model();
   model(std::vector<GLfloat> const& databuff, attrib_flag_t attribs, std::vector<GLuint> const& trianglebuff = std::vector<GLuint>{});
+  // takes over buffers without copying
+  model(std::vector<GLfloat>&& databuff, attrib_flag_t attribs, std::vector<GLuint>&& trianglebuff);
 
   std::vector<GLfloat> data;
   std::vector<GLuint> indices;
@@ -61,6 +66,12 @@ struct model {
   // size of one vertex element in bytes
   GLsizei vertex_bytes;
   std::size_t vertex_num;
+  // clusters covering all indices in order, empty unless built
+  std::vector<meshlet> meshlets;
+  std::vector<material> materials;
+  // one range per used material covering all indices, ranges sharing
+  // a diffuse texture are adjacent, empty for models built without materials
+  std::vector<submesh> submeshes;
 };
 
 #endif
\ No newline at end of file
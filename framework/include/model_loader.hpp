@@ -7,8 +7,33 @@
 
 namespace model_loader {
 
+// heap usage of one model load
+struct load_stats {
+  // allocations of the arena and of the vertex and index outputs, materials are
+  // excluded: library parsing, names, the material and submesh tables and the
+  // grouping cursors allocate through standard containers and grow with the file
+  std::size_t allocations = 0;
+  // most bytes held at once by these allocations
+  std::size_t peak_bytes = 0;
+};
+
+// triangles are grouped into one submesh per material of the library next to the model
 model obj(std::string const& path, model::attrib_flag_t import_attribs = model::POSITION);
 
+// same result as obj, but sizes everything in a counting pass first,
+// temporaries live in one arena and the outputs are allocated once
+model obj_arena(std::string const& path, model::attrib_flag_t import_attribs = model::POSITION, load_stats* stats = nullptr);
+
+// load all triangle primitives of a glTF 2.0 file, binary .glb or .gltf with external buffers,
+// buffers are mapped and read in place, normalized integer and half float attributes are
+// converted, interleaved floats in the model layout are copied without conversion,
+// one submesh per material, node transforms are not applied
+model gltf(std::string const& path, model::attrib_flag_t import_attribs = model::POSITION);
+
+// partition triangles of each submesh into meshlets of neighbouring triangles with bounds and normal cones,
+// indices are reordered so every meshlet is a contiguous range
+void build_meshlets(model& mesh, std::size_t max_vertices = 64, std::size_t max_triangles = 124);
+
 }
 
 #endif
\ No newline at end of file
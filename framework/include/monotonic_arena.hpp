@@ -0,0 +1,55 @@
+#ifndef MONOTONIC_ARENA_HPP
+#define MONOTONIC_ARENA_HPP
+
+#include <cstddef>
+
+// hands out memory from large blocks and frees all of it at once,
+// meant for temporaries that die together, destructors are never run
+class monotonic_arena {
+ public:
+  explicit monotonic_arena(std::size_t block_bytes = 1 << 16);
+  ~monotonic_arena();
+
+  monotonic_arena(monotonic_arena const&) = delete;
+  monotonic_arena& operator=(monotonic_arena const&) = delete;
+
+  // uninitialized memory, valid until release or destruction
+  void* allocate(std::size_t bytes, std::size_t alignment = 16);
+  // uninitialized array of trivial type T
+  template<typename T>
+  T* allocate_array(std::size_t count) {
+    return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+  }
+  // make sure the next allocations up to bytes need no further block
+  void reserve(std::size_t bytes);
+
+  // free all blocks
+  void release();
+
+  // blocks requested from the heap since construction
+  std::size_t block_allocations() const;
+  // bytes of all blocks currently held
+  std::size_t reserved_bytes() const;
+  // largest reserved_bytes reached
+  std::size_t peak_bytes() const;
+
+ private:
+  struct block {
+    block* previous;
+    std::size_t bytes;
+  };
+  // start new block with at least bytes usable
+  void add_block(std::size_t bytes);
+
+  std::size_t m_block_bytes;
+  block* m_block;
+  // free range of the current block
+  char* m_begin;
+  char* m_end;
+
+  std::size_t m_block_allocations;
+  std::size_t m_reserved_bytes;
+  std::size_t m_peak_bytes;
+};
+
+#endif
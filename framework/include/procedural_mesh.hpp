@@ -0,0 +1,22 @@
+#ifndef PROCEDURAL_MESH_HPP
+#define PROCEDURAL_MESH_HPP
+
+#include "model.hpp"
+
+// meshes generated directly in the interleaved model layout,
+// large levels are generated on several threads
+namespace procedural_mesh {
+
+// unit latitude longitude sphere with 4 << level rings and 8 << level segments,
+// seam vertices are duplicated so texcoords do not wrap, texcoords follow
+// u = 0.5 + atan2(-z, x) / 2pi and v = 0.5 + asin(y) / pi, so equirectangular
+// maps appear unmirrored from outside
+model uv_sphere(unsigned level, model::attrib_flag_t import_attribs = model::POSITION);
+
+// unit subdivided icosahedron, every edge is split into 2^level parts, so triangles
+// are nearly uniform in size, has no texcoords and tangents as these require a seam
+model icosphere(unsigned level, model::attrib_flag_t import_attribs = model::POSITION);
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <glbinding/gl/types.h>
+// use gl definitions from glbinding 
+using namespace gl;
+
+#include <chrono>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+// aggregated timings of one scope in milliseconds
+struct scope_stats {
+  std::size_t samples = 0;
+  double last = 0.0;
+  double min = 0.0;
+  double avg = 0.0;
+  double p99 = 0.0;
+};
+
+// measures cpu and gpu duration of named scopes over the last frames
+class profiler {
+ public:
+  // number of samples kept per scope
+  profiler(std::size_t history = 256);
+  // free query objects
+  ~profiler();
+
+  // collect finished gpu results of the frame issued buffered_frames ago
+  void begin_frame();
+  void end_frame();
+
+  // start and stop timing a scope, scopes may nest but not interleave
+  void begin(std::string const& name);
+  void end(std::string const& name);
+
+  scope_stats cpu_stats(std::string const& name) const;
+  scope_stats gpu_stats(std::string const& name) const;
+  // names of all scopes measured so far
+  std::vector<std::string> scope_names() const;
+  // whether timer queries are supported by the context
+  bool gpu_timing() const;
+  // write table of all scope stats
+  void print(std::ostream& os) const;
+  // write all scope stats as json object
+  void print_json(std::ostream& os) const;
+
+  // gpu results are read back this many frames later to avoid stalls
+  static const std::size_t buffered_frames = 2;
+
+ private:
+  // fixed size history of samples
+  struct sample_ring {
+    void push(double sample);
+    scope_stats stats() const;
+
+    std::vector<double> samples;
+    std::size_t next = 0;
+  };
+
+  struct scope_data {
+    sample_ring cpu;
+    sample_ring gpu;
+    std::chrono::steady_clock::time_point cpu_start;
+    // index of the open query pair in the current frame
+    std::size_t open_query = 0;
+  };
+
+  // timestamp pair enclosing one scope
+  struct query_pair {
+    std::size_t scope;
+    GLuint begin;
+    GLuint end;
+  };
+
+  GLuint acquire_query();
+
+  std::size_t m_history;
+  std::size_t m_frame;
+  // -1 until the context was checked for timer query support
+  int m_gpu_timing;
+
+  std::map<std::string, std::size_t> m_scope_indices;
+  std::vector<std::string> m_scope_names;
+  std::vector<scope_data> m_scopes;
+
+  std::vector<query_pair> m_pending[buffered_frames];
+  std::vector<GLuint> m_free_queries;
+};
+
+// times the enclosing block
+class profile_scope {
+ public:
+  profile_scope(profiler& prof, std::string const& name);
+  ~profile_scope();
+
+ private:
+  profiler& m_profiler;
+  std::string m_name;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef RESOLUTION_SCALER_HPP
+#define RESOLUTION_SCALER_HPP
+
+#include <cstddef>
+
+// adapts the render resolution scale to keep frames at a target duration
+class resolution_scaler {
+ public:
+  // target frame time in seconds, scale bounds relative to full resolution
+  resolution_scaler(double target_frame_time, float min_scale = 0.5f, float max_scale = 1.0f);
+
+  // feed duration of the last frame in seconds, returns the new scale
+  float update(double frame_time);
+  // current scale factor for both axes
+  float scale() const;
+  // dimension of the rendered sub-rect for a full-resolution dimension
+  int scaled(int full_size) const;
+
+  // frame time the scale is adjusted to
+  double target_frame_time;
+  // bounds of the scale factor
+  float min_scale;
+  float max_scale;
+
+ private:
+  float m_scale;
+  // smoothed frame time
+  double m_average_frame_time;
+  // frames since last adjustment
+  std::size_t m_frames_since_change;
+};
+
+#endif
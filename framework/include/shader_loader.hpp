@@ -5,14 +5,22 @@
 using namespace gl;
 
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace shader_loader {
+  // paths to vertex and fragment shader of one program
+  typedef std::pair<std::string, std::string> program_paths;
+
   // compile shader
   unsigned shader(std::string const& file_path, GLenum shader_type);
   // create program from vertex and fragment shader
   unsigned program(std::string const& vertex_name, std::string const& fragment_name);
   // create program from vertex, geometry and fragment shader
   unsigned program(std::string const& vertex_path, std::string const& geometry_path, std::string const& fragment_path);
+  // create programs from vertex and fragment shaders, all compiles and links
+  // are submitted before any status is queried, throws if one program fails
+  std::vector<unsigned> programs(std::vector<program_paths> const& paths);
 };
 
 #endif
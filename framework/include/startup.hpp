@@ -0,0 +1,33 @@
+#ifndef STARTUP_HPP
+#define STARTUP_HPP
+
+#include <iosfwd>
+#include <string>
+
+// breakdown of the time between launch and the first complete frame,
+// phases may overlap and be recorded from any thread
+namespace startup {
+  // seconds since the framework was loaded
+  double elapsed();
+  // add phase between two elapsed times, phases with equal names are accumulated
+  void record(std::string const& name, double begin, double end);
+  // add an instant, e.g. the first frame being shown
+  void mark(std::string const& name);
+  // table of phases ordered by their first beginning
+  void print(std::ostream& os);
+  // phases as json array
+  void print_json(std::ostream& os);
+
+  // records a phase from construction to destruction
+  class phase {
+   public:
+    phase(std::string const& name);
+    ~phase();
+
+   private:
+    std::string m_name;
+    double m_begin;
+  };
+};
+
+#endif
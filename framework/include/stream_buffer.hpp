@@ -0,0 +1,65 @@
+#ifndef STREAM_BUFFER_HPP
+#define STREAM_BUFFER_HPP
+
+#include <glbinding/gl/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// use gl definitions from glbinding
+using namespace gl;
+
+// ring of buffer regions for data written once per frame,
+// the region of a frame is only reused after a fence shows the gpu is done with it
+// storage is mapped persistently if ARB_buffer_storage is available,
+// otherwise every write maps its range unsynchronized
+class stream_buffer {
+ public:
+  stream_buffer(std::size_t region_bytes, std::string const& owner, std::size_t regions = 3);
+  ~stream_buffer();
+
+  stream_buffer(stream_buffer const&) = delete;
+  stream_buffer& operator=(stream_buffer const&) = delete;
+
+  // wait until the next region is free and start writing it,
+  // regions grow to hold at least reserve_bytes, which replaces the buffer
+  void begin_frame(std::size_t reserve_bytes = 0);
+  // copy data into the current region, returns its byte offset in the buffer
+  std::size_t write(void const* data, std::size_t bytes, std::size_t alignment = 16);
+  // fence the current region after all draws reading it are issued
+  void end_frame();
+
+  GLuint buffer() const;
+  // changes whenever the buffer is replaced, the gl may reuse the old name,
+  // so objects referencing the storage must compare this instead
+  std::size_t generation() const;
+  // whether storage is mapped persistently
+  bool persistent() const;
+  // frames which had to wait for the gpu to release their region
+  std::size_t stalls() const;
+
+ private:
+  // create buffer for all regions and map it if persistent
+  void allocate();
+  // delete buffer after waiting for all regions
+  void release();
+  // block until gpu passed fence and delete it, false if waiting failed
+  bool wait(GLsync& fence);
+
+  std::string m_owner;
+  bool m_persistent;
+  std::size_t m_region_bytes;
+  std::size_t m_region;
+  std::size_t m_used;
+  std::size_t m_stalls;
+
+  GLuint m_buffer;
+  std::size_t m_generation;
+  // persistent mapping of the whole buffer
+  std::uint8_t* m_mapped;
+  std::vector<GLsync> m_fences;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef SUBMESH_HPP
+#define SUBMESH_HPP
+
+#include <glm/gtc/type_precision.hpp>
+
+#include <cstddef>
+#include <string>
+
+// surface parameters from the material library of a model
+struct material {
+  std::string name;
+  glm::fvec3 ambient;
+  glm::fvec3 diffuse;
+  glm::fvec3 specular;
+  float shininess;
+  // path relative to the model file, empty if untextured
+  std::string diffuse_texture;
+};
+
+// triangles sharing one material, drawn with a single call
+struct submesh {
+  // index into the materials of the model
+  std::size_t material;
+  // triangles as range in the indices of the model
+  std::size_t index_offset;
+  std::size_t index_count;
+};
+
+#endif
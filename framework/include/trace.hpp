@@ -0,0 +1,46 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstdint>
+#include <string>
+
+// records begin and end events per thread for chrome://tracing or Perfetto
+// recording is only compiled in when FRAMEWORK_TRACING is defined
+namespace trace {
+  // names must be string literals, only the pointer is stored
+  void begin(char const* name);
+  void end(char const* name);
+  // name the calling thread in the exported timeline
+  void set_thread_name(char const* name);
+  // write recent events of all threads as trace event json, returns success
+  bool dump(std::string const& file_path);
+
+  // records the enclosing block
+  class scope {
+   public:
+    scope(char const* name)
+     :m_name{name}
+    {
+      begin(m_name);
+    }
+    ~scope() {
+      end(m_name);
+    }
+
+   private:
+    char const* m_name;
+  };
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#ifdef FRAMEWORK_TRACING
+  #define TRACE_SCOPE(name) trace::scope TRACE_CONCAT(trace_scope_, __LINE__){name}
+  #define TRACE_THREAD_NAME(name) trace::set_thread_name(name)
+#else
+  #define TRACE_SCOPE(name)
+  #define TRACE_THREAD_NAME(name)
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+
+// hands the latest state from one producer thread to one consumer thread
+// without locks, neither side ever waits for the other
+template<typename T>
+class triple_buffer {
+ public:
+  triple_buffer()
+   :m_buffers{}
+   ,m_latest{1u}
+   ,m_write{0u}
+   ,m_read{2u}
+  {}
+
+  // slot to fill by the producer, contents are stale and must be overwritten
+  T& write_buffer() {
+    return m_buffers[m_write];
+  }
+  // make written slot the latest one and take over the previous latest
+  void publish() {
+    m_write = m_latest.exchange(m_write | dirty_bit, std::memory_order_acq_rel) & index_mask;
+  }
+
+  // latest published slot, stays valid until the next call by the consumer
+  T const& read_buffer() {
+    if (m_latest.load(std::memory_order_relaxed) & dirty_bit) {
+      m_read = m_latest.exchange(m_read, std::memory_order_acq_rel) & index_mask;
+    }
+    return m_buffers[m_read];
+  }
+
+ private:
+  static const unsigned dirty_bit = 4u;
+  static const unsigned index_mask = 3u;
+
+  T m_buffers[3];
+  // index of the latest slot, dirty if not yet seen by the consumer
+  std::atomic<unsigned> m_latest;
+  // owned by producer
+  unsigned m_write;
+  // owned by consumer
+  unsigned m_read;
+};
+
+#endif
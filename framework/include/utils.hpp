@@ -5,12 +5,26 @@
 // use gl definitions from glbinding 
 using namespace gl;
 
+#include <cstddef>
+#include <string>
+
 struct pixel_data;
 struct texture_object;
 
 namespace utils {
-  // generate texture object from texture struct
-  texture_object create_texture_object(pixel_data const& tex);
+  // generate texture object from texture struct, 3d if it has depth and 2d otherwise,
+  // with a full mip chain sampled trilinearly and up to max_anisotropy samples
+  texture_object create_texture_object(pixel_data const& tex, float max_anisotropy = 8.0f);
+  // number of levels in a full mip chain
+  GLsizei mip_levels(std::size_t width, std::size_t height = 1, std::size_t depth = 1);
+  // sized internal format for pixel data of given channels and type
+  GLenum sized_format(GLenum channels, GLenum channel_type);
+  // allocate all levels of the bound texture, immutable where supported,
+  // layers of array targets are not reduced with the levels
+  void allocate_texture_storage(GLenum target, GLsizei levels, GLenum internal_format,
+                                std::size_t width, std::size_t height = 1, std::size_t depth = 1);
+  // trilinear minification of the bound texture, anisotropic where supported
+  void set_mipmap_filtering(GLenum target, float max_anisotropy);
   // print bound textures for all texture units
   void print_bound_textures();
 
@@ -23,6 +37,9 @@ namespace utils {
   // return handle of bound vertex array object
   GLint get_bound_VAO();
 
+  // check if current context exposes extension with given name
+  bool has_extension(std::string const& name);
+
   // extract filename from path
   std::string file_name(std::string const& file_path);
   // output a gl error log in cerr
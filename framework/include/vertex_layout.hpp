@@ -0,0 +1,155 @@
+#ifndef VERTEX_LAYOUT_HPP
+#define VERTEX_LAYOUT_HPP
+
+#include "model.hpp"
+
+#include <glbinding/gl/gl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+// use gl definitions from glbinding
+using namespace gl;
+
+// interleaved vertex formats described at compile time,
+// attributes are bound to consecutive locations in declaration order
+namespace vertex_attribute {
+  // flags match the model attributes, so layouts can drive the model loader
+  template<model::attrib_flag_t Flag, GLint Components>
+  struct float_attribute {
+    static constexpr model::attrib_flag_t flag = Flag;
+    static constexpr GLint components = Components;
+    static constexpr GLenum type = GL_FLOAT;
+    static constexpr std::size_t bytes = sizeof(GLfloat) * Components;
+  };
+
+  struct position : float_attribute<1 << 0, 3> {};
+  struct normal : float_attribute<1 << 1, 3> {};
+  struct texcoord : float_attribute<1 << 2, 2> {};
+  struct tangent : float_attribute<1 << 3, 3> {};
+  struct bitangent : float_attribute<1 << 4, 3> {};
+};
+
+namespace vertex_layout_detail {
+  template<typename T>
+  struct always_false {
+    static constexpr bool value = false;
+  };
+
+  // byte size and flags of all attributes
+  template<typename... Attributes>
+  struct layout_sum {
+    static constexpr std::size_t bytes = 0;
+    static constexpr model::attrib_flag_t flags = 0;
+  };
+  template<typename First, typename... Rest>
+  struct layout_sum<First, Rest...> {
+    static constexpr std::size_t bytes = First::bytes + layout_sum<Rest...>::bytes;
+    static constexpr model::attrib_flag_t flags = First::flag | layout_sum<Rest...>::flags;
+  };
+
+  // whether attribute flags strictly increase, the order models store them in
+  template<typename... Attributes>
+  struct layout_ascending {
+    static constexpr bool value = true;
+  };
+  template<typename First, typename Second, typename... Rest>
+  struct layout_ascending<First, Second, Rest...> {
+    static constexpr bool value = First::flag < Second::flag && layout_ascending<Second, Rest...>::value;
+  };
+
+  // byte offset and location of attribute Searched
+  template<typename Searched, typename... Attributes>
+  struct layout_find {
+    static_assert(always_false<Searched>::value, "attribute is not part of the vertex layout");
+    static constexpr std::size_t offset = 0;
+    static constexpr GLuint location = 0;
+  };
+  template<typename Searched, typename... Rest>
+  struct layout_find<Searched, Searched, Rest...> {
+    static constexpr std::size_t offset = 0;
+    static constexpr GLuint location = 0;
+  };
+  template<typename Searched, typename First, typename... Rest>
+  struct layout_find<Searched, First, Rest...> {
+    static constexpr std::size_t offset = First::bytes + layout_find<Searched, Rest...>::offset;
+    static constexpr GLuint location = 1 + layout_find<Searched, Rest...>::location;
+  };
+
+  // issues one attribute pointer per attribute
+  template<typename... Attributes>
+  struct layout_setup {
+    static void apply(GLsizei, std::size_t, GLuint) {}
+  };
+  template<typename First, typename... Rest>
+  struct layout_setup<First, Rest...> {
+    static void apply(GLsizei stride, std::size_t offset, GLuint location) {
+      glEnableVertexAttribArray(location);
+      glVertexAttribPointer(location, First::components, First::type, GL_FALSE, stride, (GLvoid const*)uintptr_t(offset));
+      layout_setup<Rest...>::apply(stride, offset + First::bytes, location + 1);
+    }
+  };
+};
+
+template<typename... Attributes>
+struct vertex_layout {
+  static_assert(sizeof...(Attributes) > 0, "vertex layout needs at least one attribute");
+  // offsets follow declaration order, models interleave in flag order
+  static_assert(vertex_layout_detail::layout_ascending<Attributes...>::value,
+                "vertex layout attributes must be declared in ascending flag order");
+
+  // size of one interleaved vertex in bytes
+  static constexpr GLsizei stride = GLsizei(vertex_layout_detail::layout_sum<Attributes...>::bytes);
+  // model attribute flags to request from loaders
+  static constexpr model::attrib_flag_t flags = vertex_layout_detail::layout_sum<Attributes...>::flags;
+  // floats per vertex
+  static constexpr std::size_t floats = vertex_layout_detail::layout_sum<Attributes...>::bytes / sizeof(GLfloat);
+
+  // byte offset of an attribute in the vertex, compile error if not contained
+  template<typename Attribute>
+  static constexpr std::size_t offset() {
+    return vertex_layout_detail::layout_find<Attribute, Attributes...>::offset;
+  }
+  // shader location an attribute is bound to
+  template<typename Attribute>
+  static constexpr GLuint location() {
+    return vertex_layout_detail::layout_find<Attribute, Attributes...>::location;
+  }
+
+  // describe attributes of the bound array buffer to the bound vertex array
+  static void setup_attributes() {
+    vertex_layout_detail::layout_setup<Attributes...>::apply(stride, 0, 0);
+  }
+
+  // throws if the model data is not interleaved in this layout
+  static void check(model const& m) {
+    // models and layouts both order attributes by flag, so equal flags mean equal offsets
+    for (auto const& attribute : model::VERTEX_ATTRIBS) {
+      if (bool(attribute.flag & flags) != bool(m.offsets.count(attribute.flag))) {
+        throw std::logic_error("model attributes do not match vertex layout");
+      }
+    }
+    if (m.vertex_bytes != stride || m.data.size() != m.vertex_num * floats) {
+      throw std::logic_error("model data does not match vertex layout");
+    }
+  }
+};
+
+// definitions for odr-use of the constants
+template<model::attrib_flag_t Flag, GLint Components>
+constexpr model::attrib_flag_t vertex_attribute::float_attribute<Flag, Components>::flag;
+template<model::attrib_flag_t Flag, GLint Components>
+constexpr GLint vertex_attribute::float_attribute<Flag, Components>::components;
+template<model::attrib_flag_t Flag, GLint Components>
+constexpr GLenum vertex_attribute::float_attribute<Flag, Components>::type;
+template<model::attrib_flag_t Flag, GLint Components>
+constexpr std::size_t vertex_attribute::float_attribute<Flag, Components>::bytes;
+template<typename... Attributes>
+constexpr GLsizei vertex_layout<Attributes...>::stride;
+template<typename... Attributes>
+constexpr model::attrib_flag_t vertex_layout<Attributes...>::flags;
+template<typename... Attributes>
+constexpr std::size_t vertex_layout<Attributes...>::floats;
+
+#endif
@@ -14,7 +14,10 @@ Application::Application(std::string const& resource_path)
  :m_resource_path{resource_path}
  ,m_view_transform{glm::translate(glm::fmat4{}, glm::fvec3{0.0f, 0.0f, 40.0f})}
  ,m_view_projection{1.0}
+ ,m_interpolation{1.0f}
+ ,m_deterministic{false}
  ,m_shaders{}
+ ,m_profiler{}
 {}
 
 Application::~Application() {
@@ -29,6 +32,14 @@ void Application::setProjection(glm::fmat4 const& projection_mat) {
   updateProjection();
 }
 
+void Application::setInterpolation(float alpha) {
+  m_interpolation = alpha;
+}
+
+void Application::setDeterministic(bool deterministic) {
+  m_deterministic = deterministic;
+}
+
 // update shader uniform locations
 void Application::updateUniformLocations() {
   for (auto& pair : m_shaders) {
@@ -41,4 +52,8 @@ void Application::updateUniformLocations() {
 
 std::map<std::string, shader_program>& Application::getShaderPrograms() {
   return m_shaders;
+}
+
+profiler& Application::getProfiler() {
+  return m_profiler;
 }
\ No newline at end of file
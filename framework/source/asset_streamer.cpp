@@ -0,0 +1,145 @@
+#include "asset_streamer.hpp"
+
+#include "memory_tracker.hpp"
+#include "model_loader.hpp"
+#include "startup.hpp"
+#include "texture_loader.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+  // deleter of staged assets, accounting ends once the upload step is dropped
+  template<typename T>
+  void release_host(T* asset) {
+    MEMORY_RELEASE(host, asset);
+    delete asset;
+  }
+
+  bool ends_with(std::string const& text, std::string const& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+  }
+}
+
+asset_streamer::asset_streamer(unsigned num_threads)
+ :m_workers{}
+ ,m_mutex{}
+ ,m_condition{}
+ ,m_requests{}
+ ,m_finished{}
+ ,m_pending{0}
+ ,m_running{true}
+{
+  if (num_threads == 0) {
+    // leave one core to the render and one to the simulation thread
+    unsigned cores = std::thread::hardware_concurrency();
+    num_threads = std::max(1u, std::min(4u, cores > 2 ? cores - 2 : 1u));
+  }
+  for (unsigned i = 0; i < num_threads; ++i) {
+    m_workers.emplace_back(&asset_streamer::work, this);
+  }
+}
+
+asset_streamer::~asset_streamer() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_running = false;
+  }
+  m_condition.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+void asset_streamer::request_texture(std::string const& path, std::function<void(pixel_data&)> on_ready) {
+  enqueue(path, "texture decoding", [path, on_ready]() -> completion {
+    // lambdas cannot move captures, share the decoded image instead
+    std::shared_ptr<pixel_data> pixels{new pixel_data{texture_loader::file(path)}, release_host<pixel_data>};
+    MEMORY_TRACK(host, pixels.get(), pixels->pixels.size(), "asset_streamer " + path);
+    return [pixels, on_ready]() { on_ready(*pixels); };
+  });
+}
+
+void asset_streamer::request_model(std::string const& path, model::attrib_flag_t attribs, std::function<void(model&)> on_ready) {
+  enqueue(path, "model parsing", [path, attribs, on_ready]() -> completion {
+    bool gltf = ends_with(path, ".glb") || ends_with(path, ".gltf");
+    std::shared_ptr<model> loaded{new model{gltf ? model_loader::gltf(path, attribs) : model_loader::obj_arena(path, attribs)},
+                                  release_host<model>};
+    MEMORY_TRACK(host, loaded.get(), sizeof(GLfloat) * loaded->data.size() + sizeof(GLuint) * loaded->indices.size(),
+                 "asset_streamer " + path);
+    return [loaded, on_ready]() { on_ready(*loaded); };
+  });
+}
+
+std::size_t asset_streamer::poll(std::size_t max_assets) {
+  std::vector<completion> ready{};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    while (!m_finished.empty() && ready.size() < max_assets) {
+      ready.push_back(std::move(m_finished.front()));
+      m_finished.pop_front();
+    }
+  }
+  // run outside of the lock, callbacks upload to the gpu
+  for (auto const& upload : ready) {
+    TRACE_SCOPE("asset upload");
+    startup::phase phase{"asset upload"};
+    upload();
+  }
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_pending -= ready.size();
+  }
+  return ready.size();
+}
+
+std::size_t asset_streamer::pending() const {
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_pending;
+}
+
+void asset_streamer::enqueue(std::string const& path, std::string const& phase, std::function<completion()> load) {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_requests.push_back(job{path, phase, load});
+    ++m_pending;
+  }
+  m_condition.notify_one();
+}
+
+void asset_streamer::work() {
+  TRACE_THREAD_NAME("asset streamer");
+  while (true) {
+    job current{};
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_condition.wait(lock, [this]{ return !m_requests.empty() || !m_running; });
+      if (!m_running) {
+        return;
+      }
+      current = std::move(m_requests.front());
+      m_requests.pop_front();
+    }
+
+    completion upload{};
+    try {
+      TRACE_SCOPE("asset load");
+      startup::phase phase{current.phase};
+      upload = current.load();
+    }
+    catch (std::exception const& e) {
+      // keep the placeholder, a missing asset should not end the application
+      std::string path{current.path};
+      std::string message{e.what()};
+      upload = [path, message]() {
+        std::cerr << "asset_streamer: failed to load '" << path << "' - " << message << std::endl;
+      };
+    }
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_finished.push_back(upload);
+  }
+}
@@ -0,0 +1,265 @@
+#include "chunked_mesh.hpp"
+
+#include "trace.hpp"
+
+#include <glm/gtc/type_precision.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+  // file starts with this header followed by the chunk table,
+  // values are stored in native byte order
+  struct file_header {
+    char magic[8];
+    std::uint32_t version;
+    std::int32_t attributes;
+    std::uint32_t vertex_bytes;
+    std::uint32_t reserved;
+    std::uint64_t chunk_count;
+    std::uint64_t vertex_total;
+    std::uint64_t index_total;
+  };
+
+  char const file_magic[8] = {'C', 'H', 'U', 'N', 'K', 'M', 'S', 'H'};
+  const std::uint32_t file_version = 1;
+  // chunk data starts at multiples of this
+  const std::uint64_t data_alignment = 16;
+
+  // interleave the lower 10 bits of the coordinates
+  std::uint32_t morton_code(std::uint32_t x, std::uint32_t y, std::uint32_t z) {
+    auto spread = [](std::uint32_t v) {
+      v = (v | (v << 16)) & 0x030000FFu;
+      v = (v | (v << 8)) & 0x0300F00Fu;
+      v = (v | (v << 4)) & 0x030C30C3u;
+      v = (v | (v << 2)) & 0x09249249u;
+      return v;
+    };
+    return spread(x) | (spread(y) << 1) | (spread(z) << 2);
+  }
+
+  // write zeros up to the next aligned offset
+  void pad(std::ofstream& file, std::uint64_t& offset) {
+    char const zeros[data_alignment] = {};
+    std::uint64_t aligned = (offset + data_alignment - 1) / data_alignment * data_alignment;
+    file.write(zeros, std::streamsize(aligned - offset));
+    offset = aligned;
+  }
+}
+
+chunked_mesh::chunked_mesh(std::string const& path)
+ :m_path{path}
+ ,m_file{path}
+ ,m_attributes{0}
+ ,m_vertex_bytes{0}
+ ,m_vertex_total{0}
+ ,m_index_total{0}
+ ,m_chunks{nullptr}
+ ,m_chunk_count{0}
+ ,m_uploaded{0}
+{
+  // validate header and all ranges once, so accessors need no checks,
+  // index values are checked by upload_next which reads them anyway
+  unsigned char const* data = m_file.data();
+  std::uint64_t const size = m_file.size();
+  file_header header{};
+  bool valid = size >= sizeof(file_header);
+  if (valid) {
+    std::memcpy(&header, data, sizeof(file_header));
+    valid = std::memcmp(header.magic, file_magic, sizeof(file_magic)) == 0 && header.version == file_version
+         && header.vertex_bytes > 0 && header.chunk_count <= (size - sizeof(file_header)) / sizeof(mesh_chunk);
+  }
+  if (valid) {
+    m_chunks = reinterpret_cast<mesh_chunk const*>(data + sizeof(file_header));
+    m_chunk_count = std::size_t(header.chunk_count);
+    for (std::size_t i = 0; i < m_chunk_count && valid; ++i) {
+      mesh_chunk const& part = m_chunks[i];
+      valid = part.vertex_offset % data_alignment == 0 && part.index_offset % data_alignment == 0
+           && part.vertex_offset <= size && part.vertex_count <= (size - part.vertex_offset) / header.vertex_bytes
+           && part.index_offset <= size && part.index_count <= (size - part.index_offset) / sizeof(GLuint);
+    }
+  }
+  if (!valid) {
+    throw std::logic_error("chunked_mesh: '" + path + "' is no valid chunked mesh");
+  }
+  m_attributes = model::attrib_flag_t(header.attributes);
+  m_vertex_bytes = GLsizei(header.vertex_bytes);
+  m_vertex_total = header.vertex_total;
+  m_index_total = header.index_total;
+}
+
+void chunked_mesh::write(std::string const& path, model const& mesh, std::size_t chunk_triangles) {
+  TRACE_SCOPE("chunked_mesh::write");
+  if (chunk_triangles == 0) {
+    throw std::logic_error("chunked_mesh: chunks must hold at least one triangle");
+  }
+  std::size_t const none = std::numeric_limits<std::size_t>::max();
+  std::size_t const floats = std::size_t(mesh.vertex_bytes) / sizeof(GLfloat);
+  std::size_t const triangle_num = mesh.indices.size() / 3;
+  // positions are the first attribute of every vertex
+  auto position = [&](std::size_t vertex) {
+    GLfloat const* p = &mesh.data[vertex * floats];
+    return glm::fvec3{p[0], p[1], p[2]};
+  };
+
+  glm::fvec3 bounds_min{std::numeric_limits<float>::max()};
+  glm::fvec3 bounds_max{-std::numeric_limits<float>::max()};
+  for (std::size_t vertex = 0; vertex < mesh.vertex_num; ++vertex) {
+    bounds_min = glm::min(bounds_min, position(vertex));
+    bounds_max = glm::max(bounds_max, position(vertex));
+  }
+  glm::fvec3 const cell_scale = 1023.0f / glm::max(bounds_max - bounds_min, glm::fvec3{std::numeric_limits<float>::min()});
+
+  // triangles sorted along the morton curve of their centroids, so consecutive
+  // triangles are spatially close and chunks get tight bounds
+  std::vector<std::pair<std::uint32_t, std::size_t>> order(triangle_num);
+  for (std::size_t t = 0; t < triangle_num; ++t) {
+    glm::fvec3 centroid = (position(mesh.indices[t * 3]) + position(mesh.indices[t * 3 + 1])
+                         + position(mesh.indices[t * 3 + 2])) / 3.0f;
+    glm::fvec3 cell = glm::clamp((centroid - bounds_min) * cell_scale, glm::fvec3{0.0f}, glm::fvec3{1023.0f});
+    order[t] = std::make_pair(morton_code(std::uint32_t(cell.x), std::uint32_t(cell.y), std::uint32_t(cell.z)), t);
+  }
+  std::sort(order.begin(), order.end());
+
+  std::ofstream file{path, std::ios::binary};
+  if (!file) {
+    throw std::logic_error("chunked_mesh: cannot create '" + path + "'");
+  }
+  std::vector<mesh_chunk> table((triangle_num + chunk_triangles - 1) / chunk_triangles);
+  file_header header{};
+  std::memcpy(header.magic, file_magic, sizeof(file_magic));
+  header.version = file_version;
+  for (auto const& entry : mesh.offsets) {
+    header.attributes |= std::int32_t(entry.first);
+  }
+  header.vertex_bytes = std::uint32_t(mesh.vertex_bytes);
+  header.chunk_count = table.size();
+  // table is written again once the chunk offsets are known
+  file.write(reinterpret_cast<char const*>(&header), sizeof(file_header));
+  file.write(reinterpret_cast<char const*>(table.data()), std::streamsize(table.size() * sizeof(mesh_chunk)));
+  std::uint64_t offset = sizeof(file_header) + table.size() * sizeof(mesh_chunk);
+
+  // chunk a vertex was last added to and its index there
+  std::vector<std::size_t> vertex_chunk(mesh.vertex_num, none);
+  std::vector<GLuint> local_index(mesh.vertex_num);
+  std::vector<GLfloat> vertices;
+  std::vector<GLuint> indices;
+  for (std::size_t c = 0; c < table.size(); ++c) {
+    vertices.clear();
+    indices.clear();
+    glm::fvec3 chunk_min{std::numeric_limits<float>::max()};
+    glm::fvec3 chunk_max{-std::numeric_limits<float>::max()};
+    std::size_t const last = std::min((c + 1) * chunk_triangles, triangle_num);
+    for (std::size_t t = c * chunk_triangles; t < last; ++t) {
+      for (std::size_t corner = 0; corner < 3; ++corner) {
+        GLuint vertex = mesh.indices[order[t].second * 3 + corner];
+        if (vertex_chunk[vertex] != c) {
+          vertex_chunk[vertex] = c;
+          local_index[vertex] = GLuint(vertices.size() / floats);
+          vertices.insert(vertices.end(), mesh.data.begin() + std::ptrdiff_t(vertex * floats),
+                          mesh.data.begin() + std::ptrdiff_t((vertex + 1) * floats));
+          chunk_min = glm::min(chunk_min, position(vertex));
+          chunk_max = glm::max(chunk_max, position(vertex));
+        }
+        indices.push_back(local_index[vertex]);
+      }
+    }
+
+    mesh_chunk& part = table[c];
+    part.vertex_count = std::uint32_t(vertices.size() / floats);
+    part.index_count = std::uint32_t(indices.size());
+    glm::fvec3 center = (chunk_min + chunk_max) * 0.5f;
+    part.center[0] = center.x;
+    part.center[1] = center.y;
+    part.center[2] = center.z;
+    part.radius = glm::length(chunk_max - center);
+
+    pad(file, offset);
+    part.vertex_offset = offset;
+    file.write(reinterpret_cast<char const*>(vertices.data()), std::streamsize(vertices.size() * sizeof(GLfloat)));
+    offset += vertices.size() * sizeof(GLfloat);
+    pad(file, offset);
+    part.index_offset = offset;
+    file.write(reinterpret_cast<char const*>(indices.data()), std::streamsize(indices.size() * sizeof(GLuint)));
+    offset += indices.size() * sizeof(GLuint);
+
+    header.vertex_total += part.vertex_count;
+    header.index_total += part.index_count;
+  }
+
+  file.seekp(0);
+  file.write(reinterpret_cast<char const*>(&header), sizeof(file_header));
+  file.write(reinterpret_cast<char const*>(table.data()), std::streamsize(table.size() * sizeof(mesh_chunk)));
+  if (!file) {
+    throw std::logic_error("chunked_mesh: writing '" + path + "' failed");
+  }
+}
+
+model::attrib_flag_t chunked_mesh::attributes() const {
+  return m_attributes;
+}
+
+GLsizei chunked_mesh::vertex_bytes() const {
+  return m_vertex_bytes;
+}
+
+std::uint64_t chunked_mesh::vertex_total() const {
+  return m_vertex_total;
+}
+
+std::uint64_t chunked_mesh::index_total() const {
+  return m_index_total;
+}
+
+std::size_t chunked_mesh::chunk_count() const {
+  return m_chunk_count;
+}
+
+mesh_chunk const& chunked_mesh::chunk(std::size_t index) const {
+  return m_chunks[index];
+}
+
+void const* chunked_mesh::vertices(std::size_t index) const {
+  return m_file.data() + m_chunks[index].vertex_offset;
+}
+
+GLuint const* chunked_mesh::indices(std::size_t index) const {
+  return reinterpret_cast<GLuint const*>(m_file.data() + m_chunks[index].index_offset);
+}
+
+void chunked_mesh::evict(std::size_t index) const {
+  mesh_chunk const& part = m_chunks[index];
+  m_file.evict(part.vertex_offset, part.index_offset + part.index_count * sizeof(GLuint) - part.vertex_offset);
+}
+
+bool chunked_mesh::upload_next(geometry_pool& pool, std::size_t budget_bytes, std::vector<mesh_range>& ranges) {
+  if (pool.stride() != m_vertex_bytes) {
+    throw std::logic_error("chunked_mesh: vertex layout of '" + m_path + "' does not match pool");
+  }
+  std::size_t uploaded_bytes = 0;
+  while (m_uploaded < m_chunk_count && (uploaded_bytes == 0 || uploaded_bytes < budget_bytes)) {
+    mesh_chunk const& part = m_chunks[m_uploaded];
+    // indices past the vertices of the chunk would make the gpu read out of bounds
+    GLuint const* chunk_indices = indices(m_uploaded);
+    if (std::any_of(chunk_indices, chunk_indices + part.index_count,
+                    [&part](GLuint index) { return index >= part.vertex_count; })) {
+      throw std::logic_error("chunked_mesh: chunk " + std::to_string(m_uploaded) + " of '" + m_path
+                             + "' indexes past its vertices");
+    }
+    ranges.push_back(pool.allocate(vertices(m_uploaded), part.vertex_count, indices(m_uploaded), part.index_count));
+    // the gl copied the data, the pages are not needed anymore
+    evict(m_uploaded);
+    uploaded_bytes += std::size_t(part.vertex_count) * std::size_t(m_vertex_bytes) + part.index_count * sizeof(GLuint);
+    ++m_uploaded;
+  }
+  return m_uploaded < m_chunk_count;
+}
+
+std::size_t chunked_mesh::uploaded() const {
+  return m_uploaded;
+}
@@ -0,0 +1,232 @@
+#include "culling.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <limits>
+
+// four spheres per instruction with sse, eight with avx
+#if defined(__AVX__)
+  #include <immintrin.h>
+  #define CULLING_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+  #include <xmmintrin.h>
+  #define CULLING_SSE
+#endif
+
+void sphere_set::add(glm::fvec3 const& center, float r) {
+  x.push_back(center.x);
+  y.push_back(center.y);
+  z.push_back(center.z);
+  radius.push_back(r);
+}
+
+void sphere_set::clear() {
+  x.clear();
+  y.clear();
+  z.clear();
+  radius.clear();
+}
+
+std::size_t sphere_set::size() const {
+  return radius.size();
+}
+
+frustum_culler::frustum_culler(float min_size)
+ :min_pixel_size{min_size}
+ ,m_planes{}
+ ,m_w_row{0.0f}
+ ,m_pixel_scale{0.0f}
+ ,m_eye{0.0f}
+ ,m_stats{}
+ ,m_meshlet_stats{}
+ ,m_meshlet_bounds{}
+ ,m_meshlet_visible{}
+{}
+
+void frustum_culler::update(glm::fmat4 const& view_matrix, glm::fmat4 const& projection_matrix, float viewport_height) {
+  glm::fmat4 view_projection = projection_matrix * view_matrix;
+  // glm matrices are column major, extract rows
+  glm::fvec4 rows[4];
+  for (int i = 0; i < 4; ++i) {
+    rows[i] = glm::fvec4{view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]};
+  }
+  // planes of clip space volume -w <= x,y,z <= w
+  m_planes[0] = rows[3] + rows[0];
+  m_planes[1] = rows[3] - rows[0];
+  m_planes[2] = rows[3] + rows[1];
+  m_planes[3] = rows[3] - rows[1];
+  m_planes[4] = rows[3] + rows[2];
+  m_planes[5] = rows[3] - rows[2];
+  // normalize so plane distances are in world units
+  for (auto& plane : m_planes) {
+    plane /= glm::length(glm::fvec3{plane});
+  }
+
+  m_w_row = rows[3];
+  // diameter in ndc is 2 * r * P[1][1] / w, ndc spans two viewport heights
+  m_pixel_scale = projection_matrix[1][1] * viewport_height;
+
+  m_eye = glm::fvec3{glm::inverse(view_matrix)[3]};
+  m_meshlet_stats = meshlet_stats{};
+}
+
+std::size_t frustum_culler::cull(sphere_set const& spheres, std::vector<std::uint8_t>& visible) {
+  m_stats = culling_stats{};
+  test(spheres, visible, m_stats);
+  return m_stats.visible;
+}
+
+std::size_t frustum_culler::cull_meshlets(std::vector<meshlet> const& meshlets, glm::fmat4 const& model_matrix,
+                                          std::vector<index_range>& visible) {
+  float scale = glm::length(glm::fvec3{model_matrix[0]});
+  m_meshlet_bounds.clear();
+  for (auto const& cluster : meshlets) {
+    m_meshlet_bounds.add(glm::fvec3{model_matrix * glm::fvec4{cluster.center, 1.0f}}, cluster.radius * scale);
+  }
+  culling_stats frustum_stats{};
+  test(m_meshlet_bounds, m_meshlet_visible, frustum_stats);
+
+  // ranges of earlier calls belong to other objects and are never merged
+  std::size_t const first_range = visible.size();
+  std::size_t num_visible = 0;
+  for (std::size_t i = 0; i < meshlets.size(); ++i) {
+    meshlet const& cluster = meshlets[i];
+    m_meshlet_stats.triangles_tested += cluster.index_count / 3;
+    if (!m_meshlet_visible[i]) continue;
+
+    if (cluster.cone_cutoff < 1.0f) {
+      glm::fvec3 center{m_meshlet_bounds.x[i], m_meshlet_bounds.y[i], m_meshlet_bounds.z[i]};
+      glm::fvec3 axis = glm::normalize(glm::fvec3{model_matrix * glm::fvec4{cluster.cone_axis, 0.0f}});
+      glm::fvec3 to_center = center - m_eye;
+      if (glm::dot(to_center, axis) >= cluster.cone_cutoff * glm::length(to_center) + m_meshlet_bounds.radius[i]) {
+        ++m_meshlet_stats.backface_culled;
+        continue;
+      }
+    }
+
+    ++num_visible;
+    m_meshlet_stats.triangles_visible += cluster.index_count / 3;
+    if (visible.size() > first_range && visible.back().offset + visible.back().count == cluster.index_offset) {
+      visible.back().count += cluster.index_count;
+    }
+    else {
+      visible.push_back(index_range{cluster.index_offset, cluster.index_count});
+    }
+  }
+
+  m_meshlet_stats.tested += meshlets.size();
+  m_meshlet_stats.frustum_culled += frustum_stats.frustum_culled;
+  m_meshlet_stats.size_culled += frustum_stats.size_culled;
+  m_meshlet_stats.visible += num_visible;
+  return num_visible;
+}
+
+void frustum_culler::test(sphere_set const& spheres, std::vector<std::uint8_t>& visible, culling_stats& stats) const {
+  std::size_t const num = spheres.size();
+  visible.resize(num);
+
+  stats.tested = num;
+
+  std::size_t i = 0;
+#if defined(CULLING_AVX)
+  __m256 const min_size = _mm256_set1_ps(min_pixel_size);
+  __m256 const pixel_scale = _mm256_set1_ps(m_pixel_scale);
+  for (; i + 8 <= num; i += 8) {
+    __m256 x = _mm256_loadu_ps(&spheres.x[i]);
+    __m256 y = _mm256_loadu_ps(&spheres.y[i]);
+    __m256 z = _mm256_loadu_ps(&spheres.z[i]);
+    __m256 r = _mm256_loadu_ps(&spheres.radius[i]);
+    __m256 neg_r = _mm256_sub_ps(_mm256_setzero_ps(), r);
+
+    __m256 outside = _mm256_setzero_ps();
+    for (auto const& plane : m_planes) {
+      __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane.x)),
+                                                _mm256_mul_ps(y, _mm256_set1_ps(plane.y))),
+                                  _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(plane.z)),
+                                                _mm256_set1_ps(plane.w)));
+      outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, neg_r, _CMP_LT_OQ));
+    }
+    __m256 w = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(m_w_row.x)),
+                                           _mm256_mul_ps(y, _mm256_set1_ps(m_w_row.y))),
+                             _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(m_w_row.z)),
+                                           _mm256_set1_ps(m_w_row.w)));
+    __m256 small = _mm256_cmp_ps(_mm256_mul_ps(r, pixel_scale), _mm256_mul_ps(min_size, w), _CMP_LT_OQ);
+
+    int outside_bits = _mm256_movemask_ps(outside);
+    int small_bits = _mm256_movemask_ps(_mm256_andnot_ps(outside, small));
+    for (int j = 0; j < 8; ++j) {
+      bool is_outside = (outside_bits >> j) & 1;
+      bool is_small = (small_bits >> j) & 1;
+      visible[i + j] = !(is_outside || is_small);
+      stats.frustum_culled += is_outside;
+      stats.size_culled += is_small;
+    }
+  }
+#elif defined(CULLING_SSE)
+  __m128 const min_size = _mm_set1_ps(min_pixel_size);
+  __m128 const pixel_scale = _mm_set1_ps(m_pixel_scale);
+  for (; i + 4 <= num; i += 4) {
+    __m128 x = _mm_loadu_ps(&spheres.x[i]);
+    __m128 y = _mm_loadu_ps(&spheres.y[i]);
+    __m128 z = _mm_loadu_ps(&spheres.z[i]);
+    __m128 r = _mm_loadu_ps(&spheres.radius[i]);
+    __m128 neg_r = _mm_sub_ps(_mm_setzero_ps(), r);
+
+    __m128 outside = _mm_setzero_ps();
+    for (auto const& plane : m_planes) {
+      __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)),
+                                          _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+                               _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)),
+                                          _mm_set1_ps(plane.w)));
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, neg_r));
+    }
+    __m128 w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m_w_row.x)),
+                                     _mm_mul_ps(y, _mm_set1_ps(m_w_row.y))),
+                          _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(m_w_row.z)),
+                                     _mm_set1_ps(m_w_row.w)));
+    __m128 small = _mm_cmplt_ps(_mm_mul_ps(r, pixel_scale), _mm_mul_ps(min_size, w));
+
+    int outside_bits = _mm_movemask_ps(outside);
+    int small_bits = _mm_movemask_ps(_mm_andnot_ps(outside, small));
+    for (int j = 0; j < 4; ++j) {
+      bool is_outside = (outside_bits >> j) & 1;
+      bool is_small = (small_bits >> j) & 1;
+      visible[i + j] = !(is_outside || is_small);
+      stats.frustum_culled += is_outside;
+      stats.size_culled += is_small;
+    }
+  }
+#endif
+  // remaining spheres or no simd support
+  for (; i < num; ++i) {
+    glm::fvec4 center{spheres.x[i], spheres.y[i], spheres.z[i], 1.0f};
+    float r = spheres.radius[i];
+
+    bool is_outside = false;
+    for (auto const& plane : m_planes) {
+      is_outside = is_outside || glm::dot(plane, center) < -r;
+    }
+    bool is_small = !is_outside && r * m_pixel_scale < min_pixel_size * glm::dot(m_w_row, center);
+
+    visible[i] = !(is_outside || is_small);
+    stats.frustum_culled += is_outside;
+    stats.size_culled += is_small;
+  }
+
+  stats.visible = num - stats.frustum_culled - stats.size_culled;
+}
+
+float frustum_culler::projected_size(glm::fvec3 const& center, float radius) const {
+  float w = glm::dot(m_w_row, glm::fvec4{center, 1.0f});
+  if (w <= radius) return std::numeric_limits<float>::max();
+  return radius * m_pixel_scale / w;
+}
+
+culling_stats const& frustum_culler::stats() const {
+  return m_stats;
+}
+
+meshlet_stats const& frustum_culler::meshlet_statistics() const {
+  return m_meshlet_stats;
+}
@@ -0,0 +1,118 @@
+#include "draw_batch.hpp"
+
+#include "memory_tracker.hpp"
+#include "utils.hpp"
+
+#include <glbinding/gl/gl.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+draw_batch::draw_batch(geometry_pool const& pool, GLuint draw_id_location, std::string const& owner, std::size_t capacity)
+ :m_pool(pool)
+ ,m_draw_id_location{draw_id_location}
+ ,m_owner{owner}
+ // base instance carries the draw id through the indirect command
+ ,m_indirect{utils::has_extension("GL_ARB_multi_draw_indirect") && utils::has_extension("GL_ARB_base_instance")}
+ ,m_commands{}
+ ,m_capacity{0}
+ ,m_draw_id_buffer{0}
+{
+  if (m_indirect) {
+    glGenBuffers(1, &m_draw_id_buffer);
+    reserve(capacity);
+  }
+  else {
+    // draw id comes from the constant attribute value set per draw
+    glBindVertexArray(m_pool.vertex_array());
+    glDisableVertexAttribArray(m_draw_id_location);
+  }
+  m_commands.reserve(capacity);
+}
+
+draw_batch::~draw_batch() {
+  if (m_indirect) {
+    glDeleteBuffers(1, &m_draw_id_buffer);
+    MEMORY_RELEASE(buffer, m_draw_id_buffer);
+  }
+}
+
+void draw_batch::clear() {
+  m_commands.clear();
+}
+
+GLuint draw_batch::add(mesh_range const& range) {
+  GLuint draw_id = GLuint(m_commands.size());
+  add(range, draw_id);
+  return draw_id;
+}
+
+void draw_batch::add(mesh_range const& range, GLuint draw_id) {
+  draw_elements_command command{};
+  command.count = GLuint(range.index_count);
+  command.instance_count = 1;
+  command.first_index = GLuint(range.index_offset / sizeof(GLuint));
+  command.base_vertex = range.base_vertex;
+  command.base_instance = draw_id;
+  m_commands.push_back(command);
+}
+
+void draw_batch::add(mesh_range const& mesh, std::vector<submesh> const& submeshes, GLuint first_id) {
+  for (auto const& part : submeshes) {
+    add(sub_range(mesh, part.index_offset, part.index_count), first_id + GLuint(part.material));
+  }
+}
+
+std::size_t draw_batch::size() const {
+  return m_commands.size();
+}
+
+void draw_batch::submit(stream_buffer& stream) {
+  if (m_commands.empty()) {
+    return;
+  }
+  m_pool.bind();
+
+  if (m_indirect) {
+    // ids read through base instance must exist in the id buffer
+    GLuint max_id = 0;
+    for (auto const& command : m_commands) {
+      max_id = std::max(max_id, command.base_instance);
+    }
+    reserve(std::size_t(max_id) + 1);
+    std::size_t offset = stream.write(m_commands.data(), m_commands.size() * sizeof(draw_elements_command));
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, stream.buffer());
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (GLvoid const*)uintptr_t(offset), GLsizei(m_commands.size()), 0);
+  }
+  else {
+    for (auto const& command : m_commands) {
+      glVertexAttribI1ui(m_draw_id_location, command.base_instance);
+      glDrawElementsBaseVertex(GL_TRIANGLES, GLsizei(command.count), GL_UNSIGNED_INT,
+                               (GLvoid const*)uintptr_t(command.first_index * sizeof(GLuint)), command.base_vertex);
+    }
+  }
+}
+
+bool draw_batch::indirect() const {
+  return m_indirect;
+}
+
+void draw_batch::reserve(std::size_t draws) {
+  if (draws <= m_capacity) {
+    return;
+  }
+  m_capacity = std::max(draws, m_capacity * 2);
+
+  std::vector<GLuint> draw_ids(m_capacity);
+  std::iota(draw_ids.begin(), draw_ids.end(), 0u);
+  glBindBuffer(GL_ARRAY_BUFFER, m_draw_id_buffer);
+  glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(draw_ids.size() * sizeof(GLuint)), draw_ids.data(), GL_STATIC_DRAW);
+  MEMORY_TRACK(buffer, m_draw_id_buffer, draw_ids.size() * sizeof(GLuint), m_owner + " draw ids");
+
+  // one id per instance, the instance of each draw is offset by its base instance
+  glBindVertexArray(m_pool.vertex_array());
+  glEnableVertexAttribArray(m_draw_id_location);
+  glVertexAttribIPointer(m_draw_id_location, 1, GL_UNSIGNED_INT, 0, NULL);
+  glVertexAttribDivisor(m_draw_id_location, 1);
+}
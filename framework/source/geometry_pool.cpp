@@ -0,0 +1,152 @@
+#include "geometry_pool.hpp"
+
+#include "memory_tracker.hpp"
+
+#include <glbinding/gl/gl.h>
+
+#include <algorithm>
+#include <cstdint>
+
+mesh_range sub_range(mesh_range const& mesh, std::size_t first_index, std::size_t index_count) {
+  mesh_range range{mesh};
+  range.index_count = GLsizei(index_count);
+  range.index_offset += first_index * sizeof(GLuint);
+  return range;
+}
+
+geometry_pool::geometry_pool(GLsizei stride, void (*setup_attributes)(), void (*check)(model const&),
+                             std::string const& owner, std::size_t vertex_capacity, std::size_t index_capacity)
+ :m_stride{stride}
+ ,m_setup_attributes{setup_attributes}
+ ,m_check{check}
+ ,m_owner{owner}
+ ,m_vertex_array{0}
+ ,m_vertex_buffer{0}
+ ,m_index_buffer{0}
+ ,m_vertex_capacity{std::max(vertex_capacity, std::size_t(1))}
+ ,m_index_capacity{std::max(index_capacity, std::size_t(1))}
+ ,m_vertex_count{0}
+ ,m_index_count{0}
+{
+  glGenBuffers(1, &m_vertex_buffer);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_vertex_buffer);
+  glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(m_vertex_capacity * std::size_t(m_stride)), NULL, GL_STATIC_DRAW);
+  MEMORY_TRACK(buffer, m_vertex_buffer, m_vertex_capacity * std::size_t(m_stride), m_owner + " vertices");
+
+  glGenBuffers(1, &m_index_buffer);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_index_buffer);
+  glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(m_index_capacity * sizeof(GLuint)), NULL, GL_STATIC_DRAW);
+  MEMORY_TRACK(buffer, m_index_buffer, m_index_capacity * sizeof(GLuint), m_owner + " indices");
+
+  glGenVertexArrays(1, &m_vertex_array);
+  glBindVertexArray(m_vertex_array);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+  m_setup_attributes();
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_index_buffer);
+}
+
+geometry_pool::~geometry_pool() {
+  glDeleteVertexArrays(1, &m_vertex_array);
+  glDeleteBuffers(1, &m_vertex_buffer);
+  MEMORY_RELEASE(buffer, m_vertex_buffer);
+  glDeleteBuffers(1, &m_index_buffer);
+  MEMORY_RELEASE(buffer, m_index_buffer);
+}
+
+mesh_range geometry_pool::allocate(model const& mesh) {
+  m_check(mesh);
+  return allocate(mesh.data.data(), mesh.vertex_num, mesh.indices.data(), mesh.indices.size());
+}
+
+mesh_range geometry_pool::allocate(void const* vertices, std::size_t vertex_count, GLuint const* indices, std::size_t index_count) {
+  reserve(m_vertex_count + vertex_count, m_index_count + index_count);
+
+  mesh_range range{};
+  range.index_count = GLsizei(index_count);
+  range.index_offset = m_index_count * sizeof(GLuint);
+  range.base_vertex = GLint(m_vertex_count);
+
+  // upload through the copy target to leave the bindings of vertex arrays untouched
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_vertex_buffer);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(m_vertex_count * std::size_t(m_stride)),
+                  GLsizeiptr(vertex_count * std::size_t(m_stride)), vertices);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_index_buffer);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(range.index_offset),
+                  GLsizeiptr(index_count * sizeof(GLuint)), indices);
+
+  m_vertex_count += vertex_count;
+  m_index_count += index_count;
+  return range;
+}
+
+void geometry_pool::bind() const {
+  glBindVertexArray(m_vertex_array);
+}
+
+void geometry_pool::draw(mesh_range const& range) const {
+  glDrawElementsBaseVertex(GL_TRIANGLES, range.index_count, GL_UNSIGNED_INT,
+                           (GLvoid const*)uintptr_t(range.index_offset), range.base_vertex);
+}
+
+GLsizei geometry_pool::stride() const {
+  return m_stride;
+}
+
+GLuint geometry_pool::vertex_array() const {
+  return m_vertex_array;
+}
+
+GLuint geometry_pool::vertex_buffer() const {
+  return m_vertex_buffer;
+}
+
+GLuint geometry_pool::index_buffer() const {
+  return m_index_buffer;
+}
+
+std::size_t geometry_pool::vertex_count() const {
+  return m_vertex_count;
+}
+
+std::size_t geometry_pool::index_count() const {
+  return m_index_count;
+}
+
+void geometry_pool::reserve(std::size_t vertices, std::size_t indices) {
+  bool grown = false;
+  if (vertices > m_vertex_capacity) {
+    std::size_t capacity = std::max(vertices, m_vertex_capacity * 2);
+    m_vertex_buffer = grow_buffer(m_vertex_buffer, m_vertex_count * std::size_t(m_stride), capacity * std::size_t(m_stride));
+    MEMORY_TRACK(buffer, m_vertex_buffer, capacity * std::size_t(m_stride), m_owner + " vertices");
+    m_vertex_capacity = capacity;
+    grown = true;
+  }
+  if (indices > m_index_capacity) {
+    std::size_t capacity = std::max(indices, m_index_capacity * 2);
+    m_index_buffer = grow_buffer(m_index_buffer, m_index_count * sizeof(GLuint), capacity * sizeof(GLuint));
+    MEMORY_TRACK(buffer, m_index_buffer, capacity * sizeof(GLuint), m_owner + " indices");
+    m_index_capacity = capacity;
+    grown = true;
+  }
+  if (grown) {
+    // vertex array still references the old buffers
+    glBindVertexArray(m_vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+    m_setup_attributes();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_index_buffer);
+  }
+}
+
+GLuint geometry_pool::grow_buffer(GLuint old_buffer, std::size_t used_bytes, std::size_t new_bytes) {
+  GLuint grown = 0;
+  glGenBuffers(1, &grown);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+  glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(new_bytes), NULL, GL_STATIC_DRAW);
+  if (used_bytes > 0) {
+    glBindBuffer(GL_COPY_READ_BUFFER, old_buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, GLsizeiptr(used_bytes));
+  }
+  glDeleteBuffers(1, &old_buffer);
+  MEMORY_RELEASE(buffer, old_buffer);
+  return grown;
+}
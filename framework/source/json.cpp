@@ -0,0 +1,224 @@
+#include "json.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace json {
+
+namespace {
+  value const null_value{};
+
+  // recursive descent parser over zero terminated text
+  class parser {
+   public:
+    explicit parser(char const* text)
+     :m_begin{text}
+     ,m_current{text}
+    {}
+
+    value document() {
+      value result = parse_value(0);
+      skip_spaces();
+      if (*m_current != '\0') fail("unexpected text after document");
+      return result;
+    }
+
+   private:
+    // deeper documents are rejected instead of overflowing the stack
+    static const unsigned max_depth = 256;
+
+    [[noreturn]] void fail(std::string const& message) const {
+      throw std::logic_error("json: " + message + " at offset " + std::to_string(m_current - m_begin));
+    }
+
+    void skip_spaces() {
+      while (*m_current == ' ' || *m_current == '\t' || *m_current == '\n' || *m_current == '\r') ++m_current;
+    }
+
+    void expect(char c) {
+      skip_spaces();
+      if (*m_current != c) fail(std::string{"expected '"} + c + "'");
+      ++m_current;
+    }
+
+    bool literal(char const* word) {
+      std::size_t length = std::strlen(word);
+      if (std::strncmp(m_current, word, length) != 0) return false;
+      m_current += length;
+      return true;
+    }
+
+    value parse_value(unsigned depth) {
+      if (depth > max_depth) fail("nesting too deep");
+      skip_spaces();
+      value result;
+      char c = *m_current;
+      if (c == '{') {
+        result.kind = value::object_kind;
+        ++m_current;
+        skip_spaces();
+        if (*m_current == '}') {
+          ++m_current;
+          return result;
+        }
+        while (true) {
+          skip_spaces();
+          result.keys.push_back(parse_string());
+          expect(':');
+          result.elements.emplace_back(new value{parse_value(depth + 1)});
+          skip_spaces();
+          if (*m_current != ',') break;
+          ++m_current;
+        }
+        expect('}');
+      }
+      else if (c == '[') {
+        result.kind = value::array_kind;
+        ++m_current;
+        skip_spaces();
+        if (*m_current == ']') {
+          ++m_current;
+          return result;
+        }
+        while (true) {
+          result.elements.emplace_back(new value{parse_value(depth + 1)});
+          skip_spaces();
+          if (*m_current != ',') break;
+          ++m_current;
+        }
+        expect(']');
+      }
+      else if (c == '"') {
+        result.kind = value::string_kind;
+        result.string = parse_string();
+      }
+      else if (literal("true")) {
+        result.kind = value::bool_kind;
+        result.boolean = true;
+      }
+      else if (literal("false")) {
+        result.kind = value::bool_kind;
+      }
+      else if (literal("null")) {
+        result.kind = value::null_kind;
+      }
+      else {
+        char* end = nullptr;
+        result.number = std::strtod(m_current, &end);
+        if (end == m_current) fail("unexpected character");
+        result.kind = value::number_kind;
+        m_current = end;
+      }
+      return result;
+    }
+
+    std::string parse_string() {
+      if (*m_current != '"') fail("expected string");
+      ++m_current;
+      std::string result;
+      while (*m_current != '"') {
+        char c = *m_current++;
+        if (c == '\0') fail("unterminated string");
+        if (c != '\\') {
+          result += c;
+          continue;
+        }
+        c = *m_current++;
+        switch (c) {
+          case '"': case '\\': case '/': result += c; break;
+          case 'b': result += '\b'; break;
+          case 'f': result += '\f'; break;
+          case 'n': result += '\n'; break;
+          case 'r': result += '\r'; break;
+          case 't': result += '\t'; break;
+          case 'u': append_utf8(result, parse_code_unit()); break;
+          default: fail("invalid escape");
+        }
+      }
+      ++m_current;
+      return result;
+    }
+
+    unsigned parse_code_unit() {
+      unsigned code = 0;
+      for (int i = 0; i < 4; ++i) {
+        char c = *m_current++;
+        code <<= 4;
+        if (c >= '0' && c <= '9') code |= unsigned(c - '0');
+        else if (c >= 'a' && c <= 'f') code |= unsigned(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') code |= unsigned(c - 'A' + 10);
+        else fail("invalid unicode escape");
+      }
+      // combine surrogate pair into one code point
+      if (code >= 0xD800 && code < 0xDC00 && m_current[0] == '\\' && m_current[1] == 'u') {
+        m_current += 2;
+        unsigned low = parse_code_unit();
+        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+      }
+      return code;
+    }
+
+    static void append_utf8(std::string& text, unsigned code) {
+      if (code < 0x80) {
+        text += char(code);
+      }
+      else if (code < 0x800) {
+        text += char(0xC0 | (code >> 6));
+        text += char(0x80 | (code & 0x3F));
+      }
+      else if (code < 0x10000) {
+        text += char(0xE0 | (code >> 12));
+        text += char(0x80 | ((code >> 6) & 0x3F));
+        text += char(0x80 | (code & 0x3F));
+      }
+      else {
+        text += char(0xF0 | (code >> 18));
+        text += char(0x80 | ((code >> 12) & 0x3F));
+        text += char(0x80 | ((code >> 6) & 0x3F));
+        text += char(0x80 | (code & 0x3F));
+      }
+    }
+
+    char const* m_begin;
+    char const* m_current;
+  };
+}
+
+bool value::is_null() const {
+  return kind == null_kind;
+}
+
+value const& value::operator[](std::string const& key) const {
+  if (kind == object_kind) {
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      if (keys[i] == key) return *elements[i];
+    }
+  }
+  return null_value;
+}
+
+value const& value::operator[](std::size_t index) const {
+  if (kind == array_kind && index < elements.size()) {
+    return *elements[index];
+  }
+  return null_value;
+}
+
+std::size_t value::size() const {
+  return elements.size();
+}
+
+double value::number_or(double fallback) const {
+  return kind == number_kind ? number : fallback;
+}
+
+std::string value::string_or(std::string const& fallback) const {
+  return kind == string_kind ? string : fallback;
+}
+
+value parse(std::string const& text) {
+  return parser{text.c_str()}.document();
+}
+
+}
@@ -16,40 +16,70 @@
 #include "application.hpp"
 
 #include "utils.hpp"
+#include "memory_tracker.hpp"
 #include "shader_loader.hpp"
+#include "startup.hpp"
+#include "trace.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 
 // use gl definitions from glbinding 
 using namespace gl;
 
 // helper functions
 std::string resourcePath(int argc, char* argv[]);
+unsigned unsignedOption(int argc, char* argv[], std::string const& name, unsigned default_value);
+std::string jsonEscaped(char const* text);
 void glsl_error(int error, const char* description);
 void watch_gl_errors(bool activate = true);
 
 
 Launcher::Launcher(int argc, char* argv[]) 
  :m_camera_fov{glm::radians(80.0f)}
- ,m_window_width{2048u}
- ,m_window_height{960u}
+ ,m_window_width{unsignedOption(argc, argv, "--width", 2048u)}
+ ,m_window_height{unsignedOption(argc, argv, "--height", 960u)}
  ,m_window{nullptr}
+ ,m_benchmark_frames{unsignedOption(argc, argv, "--benchmark", 0u)}
+ ,m_threaded{unsignedOption(argc, argv, "--threaded", 1u) != 0}
+ ,m_simulation_thread{}
+ ,m_frame_mutex{}
+ ,m_frame_condition{}
+ ,m_frame_requested{false}
+ ,m_frame_prepared{false}
+ ,m_simulation_running{false}
+ ,m_update_timestep{1.0 / 60.0}
+ ,m_max_updates_per_frame{5u}
+ ,m_update_accumulator{0.0}
+ ,m_last_frame_time{0.0}
  ,m_last_second_time{0.0}
  ,m_frames_per_second{0u}
+ ,m_first_frame_shown{false}
+ ,m_startup_reported{false}
  ,m_resource_path{resourcePath(argc, argv)}
  ,m_application{}
 {}
 
 std::string resourcePath(int argc, char* argv[]) {
   std::string resource_path{};
-  //first argument is resource path
-  if (argc > 1) {
-    resource_path = argv[1];
+  //first argument that is no option is resource path
+  for (int i = 1; i < argc; ++i) {
+    if (std::string{argv[i]}.compare(0, 2, "--") == 0) {
+      // skip option value
+      ++i;
+    }
+    else if (resource_path.empty()) {
+      resource_path = argv[i];
+    }
   }
   // no resource path specified, use default
-  else {
+  if (resource_path.empty()) {
     std::string exe_path{argv[0]};
     resource_path = exe_path.substr(0, exe_path.find_last_of("/\\"));
     resource_path += "/../../resources/";
@@ -58,33 +88,92 @@ std::string resourcePath(int argc, char* argv[]) {
   return resource_path;
 }
 
+// value of option given as "--name value", exits with usage on invalid numbers
+unsigned unsignedOption(int argc, char* argv[], std::string const& name, unsigned default_value) {
+  for (int i = 1; i + 1 < argc; ++i) {
+    if (name == argv[i]) {
+      std::string value{argv[i + 1]};
+      std::size_t parsed = 0;
+      unsigned long number = 0;
+      try {
+        number = std::stoul(value, &parsed);
+      }
+      // invalid_argument and out_of_range
+      catch (std::logic_error const&) {
+        parsed = 0;
+      }
+      if (parsed == 0 || parsed != value.size() || value[0] == '-' || number > std::numeric_limits<unsigned>::max()) {
+        std::cerr << "invalid value '" << value << "' for " << name << ", expected an unsigned number" << std::endl
+                  << "usage: " << argv[0] << " [resource_path] [--width pixels] [--height pixels]"
+                  << " [--benchmark frames] [--threaded 0|1]" << std::endl;
+        std::exit(EXIT_FAILURE);
+      }
+      return unsigned(number);
+    }
+  }
+  return default_value;
+}
+
+// text as contents of a json string
+std::string jsonEscaped(char const* text) {
+  std::string escaped{};
+  for (; *text != '\0'; ++text) {
+    unsigned char c = static_cast<unsigned char>(*text);
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += char(c);
+    }
+    else if (c < 0x20) {
+      char code[8];
+      std::snprintf(code, sizeof(code), "\\u%04x", unsigned(c));
+      escaped += code;
+    }
+    else {
+      escaped += char(c);
+    }
+  }
+  return escaped;
+}
+
 void Launcher::initialize() {
+  TRACE_THREAD_NAME("main");
+  TRACE_SCOPE("Launcher::initialize");
 
   glfwSetErrorCallback(glsl_error);
 
-  if (!glfwInit()) {
-    std::exit(EXIT_FAILURE);
+  {
+    startup::phase phase{"glfw init"};
+    if (!glfwInit()) {
+      std::exit(EXIT_FAILURE);
+    }
   }
 
   // set OGL version explicitly 
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, true);
+  // benchmarks render into a hidden window, works with software rasterizers
+  if (m_benchmark_frames > 0) {
+    glfwWindowHint(GLFW_VISIBLE, false);
+  }
   //MacOS requires core profile
   #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
   #else
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
   #endif
-  // create m_window, if unsuccessfull, quit
-  m_window = glfwCreateWindow(m_window_width, m_window_height, "OpenGL Framework", NULL, NULL);
-  if (!m_window) {
-    glfwTerminate();
-    std::exit(EXIT_FAILURE);
-  }
+  {
+    startup::phase phase{"window creation"};
+    // create m_window, if unsuccessfull, quit
+    m_window = glfwCreateWindow(m_window_width, m_window_height, "OpenGL Framework", NULL, NULL);
+    if (!m_window) {
+      glfwTerminate();
+      std::exit(EXIT_FAILURE);
+    }
 
-  // use the windows context
-  glfwMakeContextCurrent(m_window);
+    // use the windows context
+    glfwMakeContextCurrent(m_window);
+  }
   // disable vsync
   glfwSwapInterval(0);
   // set user pointer to access this instance statically
@@ -102,41 +191,251 @@ void Launcher::initialize() {
   };
   glfwSetFramebufferSizeCallback(m_window, resize_func);
 
-  // initialize glindings in this context
-  glbinding::Binding::initialize();
+  {
+    startup::phase phase{"glbinding init"};
+    // initialize glindings in this context, only the main thread issues gl calls,
+    // so function pointers can be resolved lazily on first use
+    glbinding::Binding::initialize(false);
+  }
 
   // activate error checking after each gl function call
   watch_gl_errors();
 }
  
-void Launcher::mainLoop() {
+void Launcher::initialize_rendering() {
   // do before framebuffer_resize call as it requires the projection uniform location
   // throw exception if shader compilation was unsuccessfull
-  update_shader_programs(true);
+  {
+    startup::phase phase{"shader compilation"};
+    update_shader_programs(true);
+  }
 
   // enable depth testing
   glEnable(GL_DEPTH_TEST);
   glDepthFunc(GL_LESS);
+}
+
+void Launcher::runLoop() {
+  if (m_benchmark_frames > 0) {
+    benchmarkLoop();
+  }
+  else if (m_threaded && m_application->concurrentUpdate()) {
+    threadedLoop();
+  }
+  else {
+    mainLoop();
+  }
+}
+
+void Launcher::mainLoop() {
+  initialize_rendering();
+
+  m_last_frame_time = glfwGetTime();
   
   // rendering loop
   while (!glfwWindowShouldClose(m_window)) {
+    TRACE_SCOPE("frame");
+    m_application->getProfiler().begin_frame();
     // query input
     glfwPollEvents();
+    // advance simulation independent of rendering rate
+    update_simulation();
+    m_application->prepareFrame();
     // clear buffer
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-    m_application->render();
+    {
+      TRACE_SCOPE("render");
+      m_application->render();
+    }
     
     // swap draw buffer to front
-    glfwSwapBuffers(m_window);
+    {
+      TRACE_SCOPE("swap buffers");
+      glfwSwapBuffers(m_window);
+    }
+    m_application->getProfiler().end_frame();
+    track_startup();
+    // display fps
+    show_fps();
+  }
+
+  quit(EXIT_SUCCESS);
+}
+
+void Launcher::threadedLoop() {
+  initialize_rendering();
+
+  m_last_frame_time = glfwGetTime();
+  m_simulation_running = true;
+  m_frame_requested = true;
+  m_simulation_thread = std::thread{&Launcher::simulationLoop, this};
+
+  // rendering loop
+  while (!glfwWindowShouldClose(m_window)) {
+    TRACE_SCOPE("frame");
+    m_application->getProfiler().begin_frame();
+    // query input
+    glfwPollEvents();
+    {
+      TRACE_SCOPE("wait for simulation");
+      // wait until frame N is prepared, then start preparing frame N+1
+      std::unique_lock<std::mutex> lock{m_frame_mutex};
+      m_frame_condition.wait(lock, [this]{ return m_frame_prepared; });
+      m_frame_prepared = false;
+      m_frame_requested = true;
+    }
+    m_frame_condition.notify_all();
+    // clear buffer
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    
+    {
+      TRACE_SCOPE("render");
+      m_application->render();
+    }
+    
+    // swap draw buffer to front
+    {
+      TRACE_SCOPE("swap buffers");
+      glfwSwapBuffers(m_window);
+    }
+    m_application->getProfiler().end_frame();
+    track_startup();
     // display fps
     show_fps();
   }
 
+  {
+    std::lock_guard<std::mutex> lock{m_frame_mutex};
+    m_simulation_running = false;
+  }
+  m_frame_condition.notify_all();
+  m_simulation_thread.join();
+
   quit(EXIT_SUCCESS);
 }
 
+void Launcher::simulationLoop() {
+  TRACE_THREAD_NAME("simulation");
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock{m_frame_mutex};
+      m_frame_condition.wait(lock, [this]{ return m_frame_requested || !m_simulation_running; });
+      if (!m_simulation_running) {
+        return;
+      }
+      m_frame_requested = false;
+    }
+
+    update_simulation();
+    {
+      TRACE_SCOPE("prepare frame");
+      m_application->prepareFrame();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{m_frame_mutex};
+      m_frame_prepared = true;
+    }
+    m_frame_condition.notify_all();
+  }
+}
+
+void Launcher::benchmarkLoop() {
+  // frames excluded from statistics while caches and drivers warm up
+  const unsigned warmup_frames = 10;
+
+  m_application->setDeterministic(true);
+  initialize_rendering();
+
+  std::vector<double> frame_times{};
+  frame_times.reserve(m_benchmark_frames);
+
+  double last_time = glfwGetTime();
+  for (unsigned frame = 0; frame_times.size() < m_benchmark_frames; ++frame) {
+    // only measure once all assets are streamed in
+    bool measured = frame >= warmup_frames && !m_application->loading();
+    m_application->getProfiler().begin_frame();
+    glfwPollEvents();
+    // every frame advances the simulation by exactly one step
+    m_application->update(m_update_timestep);
+    m_application->setInterpolation(1.0f);
+    m_application->prepareFrame();
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    m_application->render();
+    glfwSwapBuffers(m_window);
+    // include gpu work in frame time
+    glFinish();
+    m_application->getProfiler().end_frame();
+    track_startup();
+
+    double current_time = glfwGetTime();
+    if (measured) {
+      frame_times.push_back((current_time - last_time) * 1000.0);
+    }
+    last_time = current_time;
+  }
+
+  print_benchmark_results(frame_times);
+
+  quit(EXIT_SUCCESS);
+}
+
+void Launcher::print_benchmark_results(std::vector<double> frame_times) const {
+  std::sort(frame_times.begin(), frame_times.end());
+  auto percentile = [&frame_times](double p) {
+    std::size_t index = std::size_t(std::ceil(p * double(frame_times.size()))) - 1;
+    return frame_times[std::min(index, frame_times.size() - 1)];
+  };
+  double sum = 0.0;
+  for (double time : frame_times) {
+    sum += time;
+  }
+
+  std::cout << "{\n"
+            << "  \"renderer\": \"" << jsonEscaped(reinterpret_cast<char const*>(glGetString(GL_RENDERER))) << "\",\n"
+            << "  \"width\": " << m_window_width << ",\n"
+            << "  \"height\": " << m_window_height << ",\n"
+            << "  \"frames\": " << frame_times.size() << ",\n"
+            << "  \"frame_time_ms\": {"
+            << "\"min\": " << frame_times.front()
+            << ", \"avg\": " << sum / double(frame_times.size())
+            << ", \"p50\": " << percentile(0.5)
+            << ", \"p90\": " << percentile(0.9)
+            << ", \"p99\": " << percentile(0.99)
+            << ", \"max\": " << frame_times.back() << "},\n"
+            << "  \"passes\": ";
+  m_application->getProfiler().print_json(std::cout);
+  std::cout << ",\n  \"startup\": ";
+  startup::print_json(std::cout);
+  std::cout << ",\n  \"memory\": ";
+  memory_tracker::print_json(std::cout);
+  std::cout << "\n}" << std::endl;
+}
+
 ///////////////////////////// update functions ////////////////////////////////
+// run fixed simulation steps and set interpolation for rendering
+void Launcher::update_simulation() {
+  TRACE_SCOPE("update");
+  double current_time = glfwGetTime();
+  m_update_accumulator += current_time - m_last_frame_time;
+  m_last_frame_time = current_time;
+
+  unsigned steps = 0;
+  while (m_update_accumulator >= m_update_timestep && steps < m_max_updates_per_frame) {
+    m_application->update(m_update_timestep);
+    m_update_accumulator -= m_update_timestep;
+    ++steps;
+  }
+  // drop time that could not be simulated in this frame
+  if (steps == m_max_updates_per_frame) {
+    m_update_accumulator = std::min(m_update_accumulator, m_update_timestep);
+  }
+  // rendering blends between previous and current state
+  m_application->setInterpolation(float(m_update_accumulator / m_update_timestep));
+}
+
 // update viewport and field of view
 void Launcher::update_projection(GLFWwindow* m_window, int width, int height) {
   // resize framebuffer
@@ -156,17 +455,24 @@ void Launcher::update_projection(GLFWwindow* m_window, int width, int height) {
 
 // load shader programs and update uniform locations
 void Launcher::update_shader_programs(bool throwing) {
+  TRACE_SCOPE("shader reload");
   // actual functionality in lambda to allow update with and without throwing
   auto update_lambda = [&](){
+    auto& shaders = m_application->getShaderPrograms();
+    std::vector<shader_loader::program_paths> paths{};
+    for (auto const& pair : shaders) {
+      paths.emplace_back(pair.second.vertex_path, pair.second.fragment_path);
+    }
+    // compile all programs in one batch
+    // throws exception when compiling was unsuccessfull
+    std::vector<GLuint> new_programs = shader_loader::programs(paths);
     // reload all shader programs
-    for (auto& pair : m_application->getShaderPrograms()) {
-      // throws exception when compiling was unsuccessfull
-      GLuint new_program = shader_loader::program(pair.second.vertex_path,
-                                                  pair.second.fragment_path);
+    std::size_t i = 0;
+    for (auto& pair : shaders) {
       // free old shader program
       glDeleteProgram(pair.second.handle);
       // save new shader program
-      pair.second.handle = new_program;
+      pair.second.handle = new_programs[i++];
     }
   };
 
@@ -200,10 +506,43 @@ void Launcher::key_callback(GLFWwindow* m_window, int key, int scancode, int act
   else if (key == GLFW_KEY_R && action == GLFW_PRESS) {
     update_shader_programs(false);
   }
+  else if (key == GLFW_KEY_P && action == GLFW_PRESS) {
+    m_application->getProfiler().print(std::cout);
+  }
+  else if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+#ifdef FRAMEWORK_TRACING
+    trace::dump("trace.json");
+#else
+    std::cout << "tracing is compiled out, configure with FRAMEWORK_TRACING=ON" << std::endl;
+#endif
+  }
+  else if (key == GLFW_KEY_M && action == GLFW_PRESS) {
+    memory_tracker::print(std::cout);
+  }
   m_application->keyCallback(key, scancode, action, mods);
 }
 
 // calculate fps and show in m_window title
+// record first frame and completion of asset loading, report startup afterwards
+void Launcher::track_startup() {
+  if (m_startup_reported) {
+    return;
+  }
+  if (!m_first_frame_shown) {
+    startup::mark("first frame");
+    m_first_frame_shown = true;
+  }
+  if (m_application->loading()) {
+    return;
+  }
+  startup::mark("assets loaded");
+  // benchmarks include the phases in their json output
+  if (m_benchmark_frames == 0) {
+    startup::print(std::cout);
+  }
+  m_startup_reported = true;
+}
+
 void Launcher::show_fps() {
   ++m_frames_per_second;
   double current_time = glfwGetTime();
@@ -218,8 +557,17 @@ void Launcher::show_fps() {
 }
 
 void Launcher::quit(int status) {
+#ifdef FRAMEWORK_TRACING
+  trace::dump("trace.json");
+#endif
   // free opengl resources
   delete m_application;
+  // everything still registered was not freed by the application
+  std::size_t leaks = memory_tracker::print_leaks(std::cerr);
+  // fail benchmark runs, so leaks show up in automated runs
+  if (leaks > 0 && m_benchmark_frames > 0 && status == EXIT_SUCCESS) {
+    status = EXIT_FAILURE;
+  }
   // free glfw resources
   glfwDestroyWindow(m_window);
   glfwTerminate();
@@ -0,0 +1,102 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include <stdexcept>
+
+mapped_file::mapped_file(std::string const& path)
+ :m_data{nullptr}
+ ,m_size{0}
+#ifdef _WIN32
+ ,m_file{INVALID_HANDLE_VALUE}
+ ,m_mapping{nullptr}
+#else
+ ,m_file{-1}
+#endif
+{
+#ifdef _WIN32
+  m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  LARGE_INTEGER size{};
+  if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size)) {
+    unmap();
+    throw std::logic_error("mapped_file: cannot open '" + path + "'");
+  }
+  m_size = std::uint64_t(size.QuadPart);
+  m_mapping = m_size > 0 ? CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL) : nullptr;
+  if (m_mapping) {
+    m_data = static_cast<unsigned char const*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  }
+#else
+  m_file = open(path.c_str(), O_RDONLY);
+  struct stat status{};
+  if (m_file < 0 || fstat(m_file, &status) != 0) {
+    unmap();
+    throw std::logic_error("mapped_file: cannot open '" + path + "'");
+  }
+  m_size = std::uint64_t(status.st_size);
+  if (m_size > 0) {
+    void* mapped = mmap(nullptr, std::size_t(m_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (mapped != MAP_FAILED) {
+      m_data = static_cast<unsigned char const*>(mapped);
+      // files are mostly read front to back
+      madvise(mapped, std::size_t(m_size), MADV_SEQUENTIAL);
+    }
+  }
+#endif
+  if (!m_data) {
+    unmap();
+    throw std::logic_error("mapped_file: cannot map '" + path + "'");
+  }
+}
+
+mapped_file::~mapped_file() {
+  unmap();
+}
+
+unsigned char const* mapped_file::data() const {
+  return m_data;
+}
+
+std::uint64_t mapped_file::size() const {
+  return m_size;
+}
+
+void mapped_file::evict(std::uint64_t offset, std::uint64_t bytes) const {
+#ifdef _WIN32
+  // the system trims the working set of mapped views itself
+  (void)offset;
+  (void)bytes;
+#else
+  // only whole pages lying inside the range are dropped
+  std::uint64_t const page = std::uint64_t(sysconf(_SC_PAGESIZE));
+  std::uint64_t begin = (offset + page - 1) / page * page;
+  std::uint64_t end = (offset + bytes) / page * page;
+  if (begin < end && end <= m_size) {
+    madvise(const_cast<unsigned char*>(m_data) + begin, std::size_t(end - begin), MADV_DONTNEED);
+  }
+#endif
+}
+
+void mapped_file::unmap() {
+#ifdef _WIN32
+  if (m_data) UnmapViewOfFile(m_data);
+  if (m_mapping) CloseHandle(m_mapping);
+  if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+  m_mapping = nullptr;
+  m_file = INVALID_HANDLE_VALUE;
+#else
+  if (m_data) munmap(const_cast<unsigned char*>(m_data), std::size_t(m_size));
+  if (m_file >= 0) close(m_file);
+  m_file = -1;
+#endif
+  m_data = nullptr;
+}
@@ -0,0 +1,168 @@
+#include "memory_tracker.hpp"
+
+#include <glbinding/gl/enum.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+namespace {
+  struct record {
+    std::size_t bytes;
+    std::string owner;
+    char const* file;
+    int line;
+  };
+
+  std::mutex records_mutex;
+  std::map<std::pair<int, std::uintptr_t>, record> records;
+  memory_tracker::totals type_totals[memory_tracker::num_resource_types] = {};
+  memory_tracker::totals all_totals = {};
+
+  void add_bytes(memory_tracker::totals& t, std::size_t added, std::size_t removed) {
+    t.live_bytes = t.live_bytes + added - removed;
+    t.peak_bytes = std::max(t.peak_bytes, t.live_bytes);
+  }
+
+  // size of one texel, depth formats are assumed padded to 32 bit
+  std::size_t bytes_per_texel(GLenum format) {
+    switch (format) {
+      case GL_RED:
+      case GL_R8:
+        return 1;
+      case GL_RG:
+      case GL_RG8:
+      case GL_R16F:
+        return 2;
+      case GL_RGB:
+      case GL_RGB8:
+        return 3;
+      case GL_RG16F:
+      case GL_R32F:
+        return 4;
+      case GL_RGBA16F:
+        return 8;
+      case GL_RGBA32F:
+        return 16;
+      default:
+        return 4;
+    }
+  }
+}
+
+namespace memory_tracker {
+
+void track(resource_type type, std::uintptr_t id, std::size_t bytes,
+           std::string const& owner, char const* file, int line) {
+  std::lock_guard<std::mutex> lock{records_mutex};
+  auto key = std::make_pair(int(type), id);
+  auto existing = records.find(key);
+  if (existing == records.end()) {
+    records.emplace(key, record{bytes, owner, file, line});
+    ++type_totals[type].live_count;
+    ++all_totals.live_count;
+    add_bytes(type_totals[type], bytes, 0);
+    add_bytes(all_totals, bytes, 0);
+  }
+  else {
+    // reallocation of a known resource keeps its original site
+    add_bytes(type_totals[type], bytes, existing->second.bytes);
+    add_bytes(all_totals, bytes, existing->second.bytes);
+    existing->second.bytes = bytes;
+  }
+}
+
+void release(resource_type type, std::uintptr_t id) {
+  std::lock_guard<std::mutex> lock{records_mutex};
+  auto existing = records.find(std::make_pair(int(type), id));
+  if (existing == records.end()) {
+    return;
+  }
+  --type_totals[type].live_count;
+  --all_totals.live_count;
+  add_bytes(type_totals[type], 0, existing->second.bytes);
+  add_bytes(all_totals, 0, existing->second.bytes);
+  records.erase(existing);
+}
+
+totals total() {
+  std::lock_guard<std::mutex> lock{records_mutex};
+  return all_totals;
+}
+
+totals total(resource_type type) {
+  std::lock_guard<std::mutex> lock{records_mutex};
+  return type_totals[type];
+}
+
+char const* type_name(resource_type type) {
+  switch (type) {
+    case buffer:
+      return "buffer";
+    case texture:
+      return "texture";
+    case renderbuffer:
+      return "renderbuffer";
+    case framebuffer:
+      return "framebuffer";
+    case host:
+      return "host";
+    default:
+      return "unknown";
+  }
+}
+
+void print(std::ostream& os) {
+  const double mebibyte = 1024.0 * 1024.0;
+  std::ios::fmtflags flags{os.flags()};
+  os << "Memory (MiB):\n"
+     << std::left << std::setw(16) << "  type" << std::right
+     << std::setw(8) << "count" << std::setw(10) << "live" << std::setw(10) << "peak" << "\n"
+     << std::fixed << std::setprecision(2);
+  for (int i = 0; i < num_resource_types; ++i) {
+    totals t = total(resource_type(i));
+    os << "  " << std::left << std::setw(14) << type_name(resource_type(i)) << std::right
+       << std::setw(8) << t.live_count << std::setw(10) << double(t.live_bytes) / mebibyte
+       << std::setw(10) << double(t.peak_bytes) / mebibyte << "\n";
+  }
+  totals t = total();
+  os << "  " << std::left << std::setw(14) << "all" << std::right
+     << std::setw(8) << t.live_count << std::setw(10) << double(t.live_bytes) / mebibyte
+     << std::setw(10) << double(t.peak_bytes) / mebibyte << std::endl;
+  os.flags(flags);
+}
+
+void print_json(std::ostream& os) {
+  os << "{";
+  for (int i = 0; i <= num_resource_types; ++i) {
+    // last entry holds totals over all types
+    bool all = i == num_resource_types;
+    totals t = all ? total() : total(resource_type(i));
+    os << (i == 0 ? "" : ",") << "\n    \"" << (all ? "all" : type_name(resource_type(i))) << "\": {"
+       << "\"count\": " << t.live_count
+       << ", \"live_bytes\": " << t.live_bytes
+       << ", \"peak_bytes\": " << t.peak_bytes << "}";
+  }
+  os << "\n  }";
+}
+
+std::size_t print_leaks(std::ostream& os) {
+  std::lock_guard<std::mutex> lock{records_mutex};
+  for (auto const& entry : records) {
+    record const& r = entry.second;
+    os << "Leaked " << type_name(resource_type(entry.first.first)) << " " << entry.first.second
+       << " (" << r.bytes << " bytes) of " << r.owner
+       << ", created at " << r.file << ":" << r.line << std::endl;
+  }
+  return records.size();
+}
+
+std::size_t texture_bytes(GLenum internal_format, std::size_t width, std::size_t height, bool mipmaps) {
+  std::size_t bytes = bytes_per_texel(internal_format) * width * height;
+  return mipmaps ? bytes + bytes / 3 : bytes;
+}
+
+};
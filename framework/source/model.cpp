@@ -3,6 +3,7 @@
 #include <glbinding/gl/enum.h>
 
 #include <cstdint>
+#include <utility>
 
 std::vector<model::attribute> const model::VERTEX_ATTRIBS
  = {  
@@ -26,14 +27,24 @@ model::model()
  ,offsets{}
  ,vertex_bytes{0}
  ,vertex_num{0}
+ ,meshlets{}
+ ,materials{}
+ ,submeshes{}
 {}
 
 model::model(std::vector<GLfloat> const& databuff, attrib_flag_t contained_attributes, std::vector<GLuint> const& trianglebuff)
- :data(databuff)
- ,indices(trianglebuff)
+ :model{std::vector<GLfloat>(databuff), contained_attributes, std::vector<GLuint>(trianglebuff)}
+{}
+
+model::model(std::vector<GLfloat>&& databuff, attrib_flag_t contained_attributes, std::vector<GLuint>&& trianglebuff)
+ :data(std::move(databuff))
+ ,indices(std::move(trianglebuff))
  ,offsets{}
  ,vertex_bytes{0}
  ,vertex_num{0}
+ ,meshlets{}
+ ,materials{}
+ ,submeshes{}
 {
   // number of components per vertex
   std::size_t component_num = 0;
@@ -1,10 +1,28 @@
 #include "model_loader.hpp"
+#include "json.hpp"
+#include "mapped_file.hpp"
+#include "monotonic_arena.hpp"
+#include "trace.hpp"
 
 // use floats and med precision operations
 #include <glm/gtc/type_precision.hpp>
 #include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <utility>
 
 namespace model_loader {
 
@@ -12,11 +30,73 @@ void generate_normals(tinyobj::mesh_t& model);
 
 std::vector<glm::fvec3> generate_tangents(tinyobj::mesh_t const& model);
 
+namespace {
+  // directory of the model, material libraries are relative to it
+  std::string base_path(std::string const& path) {
+    return path.substr(0, path.find_last_of("/\\") + 1);
+  }
+
+  // triangles without material get a default one appended to the materials
+  std::vector<material> convert_materials(std::vector<tinyobj::material_t> const& source, bool add_default) {
+    std::vector<material> materials;
+    materials.reserve(source.size() + 1);
+    for (auto const& mat : source) {
+      materials.push_back(material{mat.name, glm::make_vec3(mat.ambient), glm::make_vec3(mat.diffuse),
+                                   glm::make_vec3(mat.specular), mat.shininess, mat.diffuse_texname});
+    }
+    if (add_default) {
+      materials.push_back(material{"default", glm::fvec3{0.0f}, glm::fvec3{0.6f}, glm::fvec3{0.0f}, 1.0f, ""});
+    }
+    return materials;
+  }
+
+  // scatter triangles into grouped so each material is one contiguous range,
+  // ranges are ordered by diffuse texture to save texture binds between them,
+  // material -1 refers to the last material of the mesh
+  void group_by_material(GLuint const* triangles, int const* triangle_materials, std::size_t triangle_num,
+                         GLuint* grouped, model& mesh) {
+    std::size_t const material_num = mesh.materials.size();
+    auto material_of = [&](std::size_t triangle) {
+      return triangle_materials[triangle] < 0 ? material_num - 1 : std::size_t(triangle_materials[triangle]);
+    };
+    std::vector<std::size_t> cursors(material_num, 0);
+    for (std::size_t t = 0; t < triangle_num; ++t) {
+      ++cursors[material_of(t)];
+    }
+
+    mesh.submeshes.clear();
+    for (std::size_t m = 0; m < material_num; ++m) {
+      if (cursors[m] > 0) {
+        mesh.submeshes.push_back(submesh{m, 0, cursors[m] * 3});
+      }
+    }
+    std::sort(mesh.submeshes.begin(), mesh.submeshes.end(), [&](submesh const& a, submesh const& b) {
+      std::string const& texture_a = mesh.materials[a.material].diffuse_texture;
+      std::string const& texture_b = mesh.materials[b.material].diffuse_texture;
+      return texture_a < texture_b || (texture_a == texture_b && a.material < b.material);
+    });
+    std::size_t offset = 0;
+    for (auto& range : mesh.submeshes) {
+      range.index_offset = offset;
+      cursors[range.material] = offset;
+      offset += range.index_count;
+    }
+
+    // stable, so triangles of one material keep their order
+    for (std::size_t t = 0; t < triangle_num; ++t) {
+      std::size_t& cursor = cursors[material_of(t)];
+      std::copy(triangles + t * 3, triangles + t * 3 + 3, grouped + cursor);
+      cursor += 3;
+    }
+  }
+}
+
 model obj(std::string const& name, model::attrib_flag_t import_attribs){
+  TRACE_SCOPE("model_loader::obj");
   std::vector<tinyobj::shape_t> shapes;
   std::vector<tinyobj::material_t> materials;
 
-  std::string err = tinyobj::LoadObj(shapes, materials, name.c_str());
+  std::string err = tinyobj::LoadObj(shapes, materials, name.c_str(), base_path(name).c_str());
 
   if (!err.empty()) {
     if (err[0] == 'W' && err[1] == 'A' && err[2] == 'R') {
@@ -31,6 +111,7 @@ model obj(std::string const& name, model::attrib_flag_t import_attribs){
 
   std::vector<float> vertex_data;
   std::vector<unsigned> triangles;
+  std::vector<int> triangle_materials;
 
   unsigned vertex_offset = 0;
 
@@ -95,11 +176,939 @@ model obj(std::string const& name, model::attrib_flag_t import_attribs){
     for (unsigned i = 0; i < curr_mesh.indices.size(); ++i) {
       triangles.push_back(vertex_offset + curr_mesh.indices[i]);
     }
+    triangle_materials.insert(triangle_materials.end(), curr_mesh.material_ids.begin(), curr_mesh.material_ids.end());
 
     vertex_offset += unsigned(curr_mesh.positions.size() / 3);
   }
 
-  return model{vertex_data, attributes, triangles};
+  model result{std::move(vertex_data), attributes, std::vector<GLuint>(triangles.size())};
+  bool without_material = std::find(triangle_materials.begin(), triangle_materials.end(), -1) != triangle_materials.end();
+  result.materials = convert_materials(materials, without_material);
+  group_by_material(triangles.data(), triangle_materials.data(), triangles.size() / 3, result.indices.data(), result);
+  return result;
+}
+
+namespace {
+  // vertex of the obj as combination of attribute indices, -1 if missing,
+  // vertices are only shared inside one group like tinyobj shapes
+  struct corner_key {
+    int group;
+    int position;
+    int texcoord;
+    int normal;
+  };
+
+  bool operator==(corner_key const& a, corner_key const& b) {
+    return a.group == b.group && a.position == b.position && a.texcoord == b.texcoord && a.normal == b.normal;
+  }
+
+  std::uint32_t hash(corner_key const& key) {
+    return std::uint32_t(key.position) * 73856093u ^ std::uint32_t(key.texcoord) * 19349663u
+         ^ std::uint32_t(key.normal) * 83492791u ^ std::uint32_t(key.group) * 2654435761u;
+  }
+
+  bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  bool is_line_end(char c) {
+    return c == '\n' || c == '\0';
+  }
+
+  void skip_spaces(char const*& token) {
+    while (is_space(*token)) ++token;
+  }
+
+  // missing values at the end of a line are zero
+  float parse_float(char const*& token) {
+    skip_spaces(token);
+    if (is_line_end(*token)) {
+      return 0.0f;
+    }
+    char* end = nullptr;
+    float value = std::strtof(token, &end);
+    token = end;
+    return value;
+  }
+
+  // convert one based or negative relative index to zero based, -1 if missing
+  int parse_index(char const*& token, int count, std::string const& path) {
+    char* end = nullptr;
+    long index = std::strtol(token, &end, 10);
+    if (end == token) {
+      return -1;
+    }
+    token = end;
+    long resolved = index > 0 ? index - 1 : count + index;
+    if (index == 0 || resolved < 0 || resolved >= count) {
+      throw std::logic_error("model_loader: index out of range in '" + path + "'");
+    }
+    return int(resolved);
+  }
+
+  // parse corner of the forms v, v/t, v//n and v/t/n
+  corner_key parse_corner(char const*& token, int group, int positions, int texcoords, int normals, std::string const& path) {
+    corner_key key{group, parse_index(token, positions, path), -1, -1};
+    if (key.position < 0) {
+      throw std::logic_error("model_loader: face without position in '" + path + "'");
+    }
+    if (*token == '/') {
+      ++token;
+      if (*token != '/') {
+        key.texcoord = parse_index(token, texcoords, path);
+      }
+      if (*token == '/') {
+        ++token;
+        key.normal = parse_index(token, normals, path);
+      }
+    }
+    return key;
+  }
+
+  // first word of the rest of a line, like tinyobj reads names
+  std::string parse_name(char const* token) {
+    skip_spaces(token);
+    char const* end = token;
+    while (!is_line_end(*end) && !is_space(*end)) ++end;
+    return std::string{token, end};
+  }
+
+  // number of corners in the rest of a face line
+  std::size_t count_corners(char const* token) {
+    std::size_t corners = 0;
+    skip_spaces(token);
+    while (!is_line_end(*token)) {
+      ++corners;
+      while (!is_line_end(*token) && !is_space(*token)) ++token;
+      skip_spaces(token);
+    }
+    return corners;
+  }
+
+  // lines are read through a fixed buffer instead of loading the whole file
+  const std::size_t line_buffer_bytes = 1 << 16;
+
+  // call function with every zero terminated line of the file
+  template<typename Function>
+  void for_each_line(std::ifstream& file, char* buffer, std::string const& path, Function const& function) {
+    file.clear();
+    file.seekg(0, std::ios::beg);
+    std::size_t filled = 0;
+    while (true) {
+      file.read(buffer + filled, std::streamsize(line_buffer_bytes - 1 - filled));
+      filled += std::size_t(file.gcount());
+      buffer[filled] = '\0';
+      bool last = !file;
+
+      char* line = buffer;
+      char* end = nullptr;
+      while ((end = static_cast<char*>(std::memchr(line, '\n', filled - std::size_t(line - buffer)))) != nullptr) {
+        *end = '\0';
+        function(line);
+        line = end + 1;
+      }
+
+      // keep incomplete last line for the next read
+      std::size_t rest = filled - std::size_t(line - buffer);
+      if (last) {
+        if (rest > 0) {
+          function(line);
+        }
+        return;
+      }
+      if (rest == line_buffer_bytes - 1) {
+        throw std::logic_error("model_loader: line too long in '" + path + "'");
+      }
+      std::memmove(buffer, line, rest);
+      filled = rest;
+    }
+  }
+}
+
+model obj_arena(std::string const& path, model::attrib_flag_t import_attribs, load_stats* stats) {
+  TRACE_SCOPE("model_loader::obj_arena");
+  std::ifstream file{path, std::ios::binary};
+  if (!file) {
+    throw std::logic_error("model_loader: cannot open '" + path + "'");
+  }
+
+  // first block holds the line buffer, second one all temporaries
+  monotonic_arena arena{line_buffer_bytes};
+  char* buffer = arena.allocate_array<char>(line_buffer_bytes);
+
+  // counting pass
+  std::size_t position_count = 0;
+  std::size_t normal_count = 0;
+  std::size_t texcoord_count = 0;
+  std::size_t corner_count = 0;
+  for_each_line(file, buffer, path, [&](char const* token) {
+    skip_spaces(token);
+    if (token[0] == 'v' && is_space(token[1])) {
+      ++position_count;
+    }
+    else if (token[0] == 'v' && token[1] == 'n' && is_space(token[2])) {
+      ++normal_count;
+    }
+    else if (token[0] == 'v' && token[1] == 't' && is_space(token[2])) {
+      ++texcoord_count;
+    }
+    else if (token[0] == 'f' && is_space(token[1])) {
+      // polygons are split into a fan of triangles
+      std::size_t corners = count_corners(token + 1);
+      if (corners >= 3) {
+        corner_count += (corners - 2) * 3;
+      }
+    }
+  });
+
+  // open addressing table, never full as there are at most as many vertices as corners
+  std::size_t table_size = 16;
+  while (table_size <= corner_count) table_size *= 2;
+  // 16 bytes alignment slack per array
+  arena.reserve(position_count * 3 * sizeof(float) + normal_count * 3 * sizeof(float) + texcoord_count * 2 * sizeof(float)
+              + corner_count * (sizeof(GLuint) + sizeof(corner_key)) + corner_count / 3 * sizeof(int)
+              + table_size * sizeof(int) + 7 * 16);
+  float* positions = arena.allocate_array<float>(position_count * 3);
+  float* normals = arena.allocate_array<float>(normal_count * 3);
+  float* texcoords = arena.allocate_array<float>(texcoord_count * 2);
+  GLuint* triangles = arena.allocate_array<GLuint>(corner_count);
+  int* triangle_materials = arena.allocate_array<int>(corner_count / 3);
+  corner_key* vertices = arena.allocate_array<corner_key>(corner_count);
+  int* table = arena.allocate_array<int>(table_size);
+  std::fill(table, table + table_size, -1);
+
+  // parsing pass
+  std::size_t vertex_count = 0;
+  std::size_t triangle_corners = 0;
+  int p = 0;
+  int n = 0;
+  int t = 0;
+  int group = 0;
+  // materials are looked up by name, -1 if none is in use
+  std::vector<tinyobj::material_t> library;
+  std::map<std::string, int> library_names;
+  int current_material = -1;
+  bool without_material = false;
+  for_each_line(file, buffer, path, [&](char const* token) {
+    skip_spaces(token);
+    if (token[0] == 'v' && is_space(token[1])) {
+      token += 2;
+      for (int i = 0; i < 3; ++i) positions[p * 3 + i] = parse_float(token);
+      ++p;
+    }
+    else if (token[0] == 'v' && token[1] == 'n' && is_space(token[2])) {
+      token += 3;
+      for (int i = 0; i < 3; ++i) normals[n * 3 + i] = parse_float(token);
+      ++n;
+    }
+    else if (token[0] == 'v' && token[1] == 't' && is_space(token[2])) {
+      token += 3;
+      for (int i = 0; i < 2; ++i) texcoords[t * 2 + i] = parse_float(token);
+      ++t;
+    }
+    else if ((token[0] == 'g' || token[0] == 'o') && is_space(token[1])) {
+      ++group;
+    }
+    else if (std::strncmp(token, "mtllib", 6) == 0 && is_space(token[6])) {
+      std::string library_path = base_path(path) + parse_name(token + 7);
+      std::ifstream library_file{library_path};
+      if (!library_file) {
+        std::cerr << "model_loader: material library '" << library_path << "' not found" << std::endl;
+        return;
+      }
+      std::string err = tinyobj::LoadMtl(library_names, library, library_file);
+      if (!err.empty()) {
+        std::cerr << "tinyobjloader: " << err << std::endl;
+      }
+    }
+    else if (std::strncmp(token, "usemtl", 6) == 0 && is_space(token[6])) {
+      auto found = library_names.find(parse_name(token + 7));
+      current_material = found != library_names.end() ? found->second : -1;
+    }
+    else if (token[0] == 'f' && is_space(token[1])) {
+      // faces without area were not counted, their corners must not become vertices
+      if (count_corners(token + 1) < 3) return;
+      token += 2;
+      skip_spaces(token);
+      GLuint first = 0;
+      GLuint previous = 0;
+      for (std::size_t corner = 0; !is_line_end(*token); ++corner) {
+        corner_key key = parse_corner(token, group, p, t, n, path);
+        while (!is_line_end(*token) && !is_space(*token)) ++token;
+        skip_spaces(token);
+
+        // find vertex or append it, a free slot always remains
+        assert(vertex_count < table_size);
+        std::size_t slot = hash(key) & (table_size - 1);
+        while (table[slot] >= 0 && !(vertices[table[slot]] == key)) {
+          slot = (slot + 1) & (table_size - 1);
+        }
+        if (table[slot] < 0) {
+          table[slot] = int(vertex_count);
+          vertices[vertex_count++] = key;
+        }
+        GLuint vertex = GLuint(table[slot]);
+
+        if (corner == 0) {
+          first = vertex;
+        }
+        else if (corner >= 2) {
+          triangle_materials[triangle_corners / 3] = current_material;
+          without_material = without_material || current_material < 0;
+          triangles[triangle_corners++] = first;
+          triangles[triangle_corners++] = previous;
+          triangles[triangle_corners++] = vertex;
+        }
+        previous = vertex;
+      }
+    }
+  });
+
+  // attributes are only used if every vertex references them
+  bool has_normals = (import_attribs & model::NORMAL) != 0;
+  bool has_uvs = (import_attribs & model::TEXCOORD) != 0;
+  bool file_normals = normal_count > 0;
+  bool file_uvs = texcoord_count > 0;
+  for (std::size_t i = 0; i < vertex_count; ++i) {
+    file_normals = file_normals && vertices[i].normal >= 0;
+    file_uvs = file_uvs && vertices[i].texcoord >= 0;
+  }
+  model::attrib_flag_t attributes{model::POSITION | import_attribs};
+  if (has_uvs && !file_uvs) {
+    has_uvs = false;
+    attributes ^= model::TEXCOORD;
+    std::cerr << "Shape has no texcoords" << std::endl;
+  }
+  if (import_attribs & model::TANGENT) {
+    if (!has_uvs) {
+      attributes ^= model::TANGENT;
+      std::cerr << "Shape has no texcoords" << std::endl;
+    }
+    else {
+      throw std::logic_error("Tangent creation not implemented yet");
+    }
+  }
+
+  // generate normals by accumulating face normals like generate_normals,
+  // only this adds a block to the arena
+  glm::fvec3* generated_normals = nullptr;
+  if (has_normals && !file_normals) {
+    generated_normals = arena.allocate_array<glm::fvec3>(vertex_count);
+    std::fill(generated_normals, generated_normals + vertex_count, glm::fvec3{0.0f});
+    for (std::size_t i = 0; i < triangle_corners; i += 3) {
+      glm::fvec3 corners[3];
+      for (std::size_t c = 0; c < 3; ++c) {
+        float const* position = positions + vertices[triangles[i + c]].position * 3;
+        corners[c] = glm::fvec3{position[0], position[1], position[2]};
+      }
+      glm::fvec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+      for (std::size_t c = 0; c < 3; ++c) {
+        generated_normals[triangles[i + c]] += normal;
+      }
+    }
+  }
+
+  // outputs are allocated once at their final size and moved into the model
+  std::size_t floats_per_vertex = 3 + (has_normals ? 3 : 0) + (has_uvs ? 2 : 0);
+  std::vector<GLfloat> vertex_data(vertex_count * floats_per_vertex);
+  std::vector<GLuint> indices(triangle_corners);
+
+  GLfloat* out = vertex_data.data();
+  for (std::size_t i = 0; i < vertex_count; ++i) {
+    corner_key const& key = vertices[i];
+    out = std::copy(positions + key.position * 3, positions + key.position * 3 + 3, out);
+    if (has_normals) {
+      if (generated_normals) {
+        glm::fvec3 normal = glm::normalize(generated_normals[i]);
+        *out++ = normal.x;
+        *out++ = normal.y;
+        *out++ = normal.z;
+      }
+      else {
+        out = std::copy(normals + key.normal * 3, normals + key.normal * 3 + 3, out);
+      }
+    }
+    if (has_uvs) {
+      out = std::copy(texcoords + key.texcoord * 2, texcoords + key.texcoord * 2 + 2, out);
+    }
+  }
+
+  std::size_t output_bytes = vertex_data.size() * sizeof(GLfloat) + indices.size() * sizeof(GLuint);
+  model result{std::move(vertex_data), attributes, std::move(indices)};
+  result.materials = convert_materials(library, without_material);
+  group_by_material(triangles, triangle_materials, triangle_corners / 3, result.indices.data(), result);
+
+  if (stats) {
+    // arena blocks and the two outputs, see load_stats for what is excluded
+    stats->allocations = arena.block_allocations() + 2;
+    stats->peak_bytes = arena.peak_bytes() + output_bytes;
+  }
+
+  return result;
+}
+
+void build_meshlets(model& mesh, std::size_t max_vertices, std::size_t max_triangles) {
+  TRACE_SCOPE("model_loader::build_meshlets");
+  if (max_vertices < 3 || max_triangles < 1) {
+    throw std::logic_error("model_loader: meshlets must hold at least one triangle");
+  }
+  std::size_t const none = std::size_t(-1);
+  std::size_t const triangle_num = mesh.indices.size() / 3;
+  // positions are the first attribute of every vertex
+  std::size_t const floats = std::size_t(mesh.vertex_bytes) / sizeof(GLfloat);
+  auto position = [&](GLuint vertex) {
+    GLfloat const* p = &mesh.data[vertex * floats];
+    return glm::fvec3{p[0], p[1], p[2]};
+  };
+
+  // triangles using each vertex, ranges given by the offsets
+  std::vector<std::size_t> adjacency_offsets(mesh.vertex_num + 1, 0);
+  for (GLuint index : mesh.indices) {
+    ++adjacency_offsets[index + 1];
+  }
+  for (std::size_t i = 1; i < adjacency_offsets.size(); ++i) {
+    adjacency_offsets[i] += adjacency_offsets[i - 1];
+  }
+  std::vector<std::size_t> adjacency(mesh.indices.size());
+  std::vector<std::size_t> adjacency_fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+  for (std::size_t i = 0; i < mesh.indices.size(); ++i) {
+    adjacency[adjacency_fill[mesh.indices[i]]++] = i / 3;
+  }
+
+  // distances are measured relative to half the diagonal of the mesh bounds
+  glm::fvec3 bounds_min{std::numeric_limits<float>::max()};
+  glm::fvec3 bounds_max{-std::numeric_limits<float>::max()};
+  for (std::size_t vertex = 0; vertex < mesh.vertex_num; ++vertex) {
+    bounds_min = glm::min(bounds_min, position(GLuint(vertex)));
+    bounds_max = glm::max(bounds_max, position(GLuint(vertex)));
+  }
+  float const extent = std::max(glm::length(bounds_max - bounds_min) * 0.5f, std::numeric_limits<float>::min());
+
+  // unit normal and centroid of every triangle
+  std::vector<glm::fvec3> face_normals(triangle_num, glm::fvec3{0.0f});
+  std::vector<glm::fvec3> face_centers(triangle_num);
+  for (std::size_t t = 0; t < triangle_num; ++t) {
+    glm::fvec3 a = position(mesh.indices[t * 3]);
+    glm::fvec3 b = position(mesh.indices[t * 3 + 1]);
+    glm::fvec3 c = position(mesh.indices[t * 3 + 2]);
+    glm::fvec3 normal = glm::cross(b - a, c - a);
+    // degenerate triangles are never visible and do not widen cones
+    if (glm::length(normal) > 0.0f) {
+      face_normals[t] = glm::normalize(normal);
+    }
+    face_centers[t] = (a + b + c) / 3.0f;
+  }
+
+  // meshlets stay inside one submesh, so submesh ranges remain valid after reordering
+  std::vector<std::size_t> triangle_submesh(triangle_num, 0);
+  for (std::size_t s = 0; s < mesh.submeshes.size(); ++s) {
+    submesh const& range = mesh.submeshes[s];
+    std::fill(triangle_submesh.begin() + std::ptrdiff_t(range.index_offset / 3),
+              triangle_submesh.begin() + std::ptrdiff_t((range.index_offset + range.index_count) / 3), s);
+  }
+
+  std::vector<bool> emitted(triangle_num, false);
+  // meshlet a vertex was last added to, avoids clearing a set per meshlet
+  std::vector<std::size_t> vertex_meshlet(mesh.vertex_num, none);
+  std::vector<GLuint> reordered;
+  reordered.reserve(mesh.indices.size());
+  std::vector<GLuint> vertices;
+  std::vector<std::size_t> triangles;
+  mesh.meshlets.clear();
+
+  std::size_t seed = 0;
+  while (true) {
+    // start at the first triangle not emitted yet
+    while (seed < triangle_num && emitted[seed]) ++seed;
+    if (seed == triangle_num) break;
+
+    std::size_t const id = mesh.meshlets.size();
+    vertices.clear();
+    triangles.clear();
+    glm::fvec3 cluster_normal{0.0f};
+    glm::fvec3 cluster_center{0.0f};
+    // grow by the neighbouring triangle adding few vertices, close to the cluster
+    // and facing its way, compact clusters with narrow cones cull best
+    for (std::size_t candidate = seed; candidate != none;) {
+      emitted[candidate] = true;
+      triangles.push_back(candidate);
+      cluster_normal += face_normals[candidate];
+      cluster_center += face_centers[candidate];
+      for (std::size_t c = 0; c < 3; ++c) {
+        GLuint vertex = mesh.indices[candidate * 3 + c];
+        if (vertex_meshlet[vertex] != id) {
+          vertex_meshlet[vertex] = id;
+          vertices.push_back(vertex);
+        }
+      }
+      if (triangles.size() == max_triangles) break;
+
+      glm::fvec3 mean_normal = glm::length(cluster_normal) > 0.0f ? glm::normalize(cluster_normal) : cluster_normal;
+      glm::fvec3 mean_center = cluster_center / float(triangles.size());
+      candidate = none;
+      float best_score = 0.0f;
+      for (std::size_t v = 0; v < vertices.size(); ++v) {
+        for (std::size_t a = adjacency_offsets[vertices[v]]; a < adjacency_offsets[vertices[v] + 1]; ++a) {
+          std::size_t triangle = adjacency[a];
+          if (emitted[triangle] || triangle_submesh[triangle] != triangle_submesh[seed]) continue;
+          std::size_t added = 0;
+          for (std::size_t c = 0; c < 3; ++c) {
+            added += vertex_meshlet[mesh.indices[triangle * 3 + c]] != id;
+          }
+          if (vertices.size() + added > max_vertices) continue;
+          float score = float(added) + (1.0f - glm::dot(face_normals[triangle], mean_normal))
+                      + 2.0f * glm::length(face_centers[triangle] - mean_center) / extent;
+          if (candidate == none || score < best_score) {
+            best_score = score;
+            candidate = triangle;
+          }
+        }
+      }
+    }
+
+    meshlet cluster{};
+    cluster.index_offset = reordered.size();
+    cluster.index_count = triangles.size() * 3;
+    for (std::size_t triangle : triangles) {
+      reordered.insert(reordered.end(), mesh.indices.begin() + std::ptrdiff_t(triangle * 3),
+                       mesh.indices.begin() + std::ptrdiff_t(triangle * 3 + 3));
+    }
+
+    // sphere around the vertex centroid
+    glm::fvec3 center{0.0f};
+    for (GLuint vertex : vertices) {
+      center += position(vertex);
+    }
+    cluster.center = center / float(vertices.size());
+    for (GLuint vertex : vertices) {
+      cluster.radius = std::max(cluster.radius, glm::length(position(vertex) - cluster.center));
+    }
+
+    // cone around the mean normal containing all face normals
+    glm::fvec3 normal_sum{0.0f};
+    for (std::size_t triangle : triangles) {
+      normal_sum += face_normals[triangle];
+    }
+    cluster.cone_cutoff = 1.0f;
+    if (glm::length(normal_sum) > 0.0f) {
+      cluster.cone_axis = glm::normalize(normal_sum);
+      float min_cosine = 1.0f;
+      for (std::size_t triangle : triangles) {
+        if (face_normals[triangle] != glm::fvec3{0.0f}) {
+          min_cosine = std::min(min_cosine, glm::dot(cluster.cone_axis, face_normals[triangle]));
+        }
+      }
+      // cones wider than about 84 degrees hardly ever face away
+      if (min_cosine > 0.1f) {
+        cluster.cone_cutoff = std::sqrt(1.0f - min_cosine * min_cosine);
+      }
+    }
+    mesh.meshlets.push_back(cluster);
+  }
+  mesh.indices.swap(reordered);
+}
+
+namespace {
+  // little endian words of the glb container
+  const std::uint32_t glb_magic = 0x46546C67;
+  const std::uint32_t glb_json_chunk = 0x4E4F534A;
+  const std::uint32_t glb_binary_chunk = 0x004E4942;
+
+  // gltf component types, half floats are no core type but written by some exporters
+  const unsigned byte_type = 5120;
+  const unsigned unsigned_byte_type = 5121;
+  const unsigned short_type = 5122;
+  const unsigned unsigned_short_type = 5123;
+  const unsigned unsigned_int_type = 5125;
+  const unsigned float_type = 5126;
+  const unsigned half_float_type = 5131;
+
+  std::uint32_t read_u32(unsigned char const* bytes) {
+    return std::uint32_t(bytes[0]) | std::uint32_t(bytes[1]) << 8 | std::uint32_t(bytes[2]) << 16 | std::uint32_t(bytes[3]) << 24;
+  }
+
+  // index stored in a json value, none if missing or invalid
+  std::size_t to_index(json::value const& value) {
+    double number = value.number_or(-1.0);
+    return number >= 0.0 ? std::size_t(number) : std::numeric_limits<std::size_t>::max();
+  }
+
+  std::size_t component_bytes(unsigned type) {
+    switch (type) {
+      case byte_type: case unsigned_byte_type: return 1;
+      case short_type: case unsigned_short_type: case half_float_type: return 2;
+      case unsigned_int_type: case float_type: return 4;
+      default: throw std::logic_error("model_loader: unsupported gltf component type " + std::to_string(type));
+    }
+  }
+
+  std::size_t component_count(std::string const& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    throw std::logic_error("model_loader: unsupported gltf accessor type '" + type + "'");
+  }
+
+  // elements of an accessor inside a mapped buffer
+  struct accessor_data {
+    // null if the accessor has no buffer view, its elements are zero then
+    unsigned char const* data;
+    std::size_t count;
+    std::size_t stride;
+    unsigned type;
+    std::size_t components;
+    bool normalized;
+  };
+
+  // normalized integers map to [0, 1] or [-1, 1], others keep their value
+  float read_component(unsigned char const* bytes, unsigned type, bool normalized) {
+    switch (type) {
+      case float_type: {
+        float value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+      }
+      case half_float_type: {
+        glm::uint16 value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return glm::unpackHalf1x16(value);
+      }
+      case byte_type: {
+        float value = float(std::int8_t(bytes[0]));
+        return normalized ? std::max(value / 127.0f, -1.0f) : value;
+      }
+      case unsigned_byte_type: {
+        float value = float(bytes[0]);
+        return normalized ? value / 255.0f : value;
+      }
+      case short_type: {
+        std::int16_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return normalized ? std::max(float(value) / 32767.0f, -1.0f) : float(value);
+      }
+      case unsigned_short_type: {
+        std::uint16_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return normalized ? float(value) / 65535.0f : float(value);
+      }
+      default: {
+        std::uint32_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return float(value);
+      }
+    }
+  }
+
+  // approximate metallic roughness parameters with the phong model
+  material convert_material(json::value const& document, json::value const& source) {
+    json::value const& pbr = source["pbrMetallicRoughness"];
+    json::value const& factor = pbr["baseColorFactor"];
+    glm::fvec3 base_color{float(factor[std::size_t(0)].number_or(1.0)), float(factor[1].number_or(1.0)),
+                          float(factor[2].number_or(1.0))};
+    float metallic = float(pbr["metallicFactor"].number_or(1.0));
+    float roughness = std::max(float(pbr["roughnessFactor"].number_or(1.0)), 0.01f);
+    float alpha = roughness * roughness;
+
+    material result{source["name"].string_or(""), glm::fvec3{0.0f}, base_color * (1.0f - metallic),
+                    glm::mix(glm::fvec3{0.04f}, base_color, metallic),
+                    std::max(2.0f / (alpha * alpha) - 2.0f, 1.0f), ""};
+    // images inside buffers have no path and stay untextured
+    std::size_t texture = to_index(pbr["baseColorTexture"]["index"]);
+    std::size_t image = to_index(document["textures"][texture]["source"]);
+    result.diffuse_texture = document["images"][image]["uri"].string_or("");
+    return result;
+  }
+}
+
+model gltf(std::string const& path, model::attrib_flag_t import_attribs) {
+  TRACE_SCOPE("model_loader::gltf");
+  std::size_t const none = std::numeric_limits<std::size_t>::max();
+  mapped_file file{path};
+  unsigned char const* bytes = file.data();
+  std::uint64_t const size = file.size();
+
+  // glb holds a json chunk and an optional binary chunk, plain gltf is only the json
+  std::string json_text;
+  unsigned char const* binary = nullptr;
+  std::uint64_t binary_size = 0;
+  if (size >= 12 && read_u32(bytes) == glb_magic) {
+    if (read_u32(bytes + 4) != 2) {
+      throw std::logic_error("model_loader: '" + path + "' is no glTF 2.0 file");
+    }
+    std::uint64_t const length = std::min(std::uint64_t(read_u32(bytes + 8)), size);
+    std::uint64_t offset = 12;
+    while (offset + 8 <= length) {
+      std::uint32_t chunk_length = read_u32(bytes + offset);
+      std::uint32_t chunk_type = read_u32(bytes + offset + 4);
+      offset += 8;
+      if (chunk_length > length - offset) {
+        throw std::logic_error("model_loader: chunk exceeds '" + path + "'");
+      }
+      if (chunk_type == glb_json_chunk && json_text.empty()) {
+        json_text.assign(reinterpret_cast<char const*>(bytes + offset), chunk_length);
+      }
+      else if (chunk_type == glb_binary_chunk && !binary) {
+        binary = bytes + offset;
+        binary_size = chunk_length;
+      }
+      // chunks are padded to four bytes
+      offset += (std::uint64_t(chunk_length) + 3) / 4 * 4;
+    }
+  }
+  else {
+    json_text.assign(reinterpret_cast<char const*>(bytes), std::size_t(size));
+  }
+  json::value const document = json::parse(json_text);
+
+  // buffers without uri are the binary chunk, others are mapped from files next to the model
+  std::vector<std::unique_ptr<mapped_file>> external_files;
+  std::vector<std::pair<unsigned char const*, std::uint64_t>> buffers;
+  for (auto const& element : document["buffers"].elements) {
+    json::value const& buffer = *element;
+    std::string const uri = buffer["uri"].string_or("");
+    if (uri.empty()) {
+      if (!binary) {
+        throw std::logic_error("model_loader: '" + path + "' has no binary chunk");
+      }
+      buffers.emplace_back(binary, binary_size);
+    }
+    else if (uri.compare(0, 5, "data:") == 0) {
+      throw std::logic_error("model_loader: data uris in '" + path + "' are not supported");
+    }
+    else {
+      external_files.emplace_back(new mapped_file{base_path(path) + uri});
+      buffers.emplace_back(external_files.back()->data(), external_files.back()->size());
+    }
+    if (buffer["byteLength"].number_or(0.0) > double(buffers.back().second)) {
+      throw std::logic_error("model_loader: buffer exceeds its data in '" + path + "'");
+    }
+  }
+
+  auto accessor = [&](std::size_t index) {
+    json::value const& source = document["accessors"][index];
+    if (source.is_null() || !source["sparse"].is_null()) {
+      throw std::logic_error("model_loader: missing or sparse accessor in '" + path + "'");
+    }
+    accessor_data result{};
+    result.count = to_index(source["count"]);
+    result.type = unsigned(source["componentType"].number_or(0.0));
+    result.components = component_count(source["type"].string_or(""));
+    result.normalized = source["normalized"].boolean;
+    std::size_t const element_bytes = component_bytes(result.type) * result.components;
+    result.stride = element_bytes;
+    std::size_t const view_index = to_index(source["bufferView"]);
+    if (view_index == none) {
+      return result;
+    }
+
+    json::value const& view = document["bufferViews"][view_index];
+    std::size_t const buffer = to_index(view["buffer"]);
+    std::uint64_t const view_offset = std::uint64_t(view["byteOffset"].number_or(0.0));
+    std::uint64_t const view_length = std::uint64_t(view["byteLength"].number_or(0.0));
+    std::uint64_t const offset = std::uint64_t(source["byteOffset"].number_or(0.0));
+    result.stride = std::size_t(view["byteStride"].number_or(double(element_bytes)));
+    if (result.count == none || buffer >= buffers.size() || view_offset + view_length > buffers[buffer].second
+        || (result.count > 0 && offset + std::uint64_t(result.stride) * (result.count - 1) + element_bytes > view_length)) {
+      throw std::logic_error("model_loader: accessor " + std::to_string(index) + " exceeds its buffer in '" + path + "'");
+    }
+    result.data = buffers[buffer].first + view_offset + offset;
+    return result;
+  };
+
+  // triangle primitives of all meshes, node transforms are not applied
+  std::vector<json::value const*> primitives;
+  for (auto const& mesh : document["meshes"].elements) {
+    for (auto const& element : (*mesh)["primitives"].elements) {
+      json::value const& primitive = *element;
+      if (primitive["mode"].number_or(4.0) != 4.0) {
+        std::cerr << "model_loader: skipping primitive which is no triangle list in '" << path << "'" << std::endl;
+        continue;
+      }
+      primitives.push_back(&primitive);
+    }
+  }
+
+  // attributes are only used if every primitive has them
+  auto all_have = [&](char const* name) {
+    for (auto primitive : primitives) {
+      if ((*primitive)["attributes"][name].is_null()) return false;
+    }
+    return true;
+  };
+  bool const has_normals = (import_attribs & model::NORMAL) != 0;
+  bool const file_normals = has_normals && all_have("NORMAL");
+  bool has_uvs = (import_attribs & model::TEXCOORD) != 0;
+  if (has_uvs && !all_have("TEXCOORD_0")) {
+    has_uvs = false;
+    std::cerr << "Shape has no texcoords" << std::endl;
+  }
+  bool has_tangents = (import_attribs & model::TANGENT) != 0;
+  if (has_tangents && !all_have("TANGENT")) {
+    has_tangents = false;
+    std::cerr << "Shape has no tangents" << std::endl;
+  }
+  model::attrib_flag_t attributes{model::POSITION};
+  if (has_normals) attributes |= model::NORMAL;
+  if (has_uvs) attributes |= model::TEXCOORD;
+  if (has_tangents) attributes |= model::TANGENT;
+
+  // attributes in order of the model layout, the offset counts floats
+  struct source_attribute {
+    char const* name;
+    std::size_t offset;
+    std::size_t components;
+  };
+  std::vector<source_attribute> sources{{"POSITION", 0, 3}};
+  std::size_t floats_per_vertex = 3;
+  if (has_normals) {
+    if (file_normals) sources.push_back(source_attribute{"NORMAL", floats_per_vertex, 3});
+    floats_per_vertex += 3;
+  }
+  if (has_uvs) {
+    sources.push_back(source_attribute{"TEXCOORD_0", floats_per_vertex, 2});
+    floats_per_vertex += 2;
+  }
+  if (has_tangents) {
+    // handedness in the fourth component is dropped
+    sources.push_back(source_attribute{"TANGENT", floats_per_vertex, 3});
+    floats_per_vertex += 3;
+  }
+  std::size_t const vertex_bytes = floats_per_vertex * sizeof(GLfloat);
+
+  // sizes first, so outputs are allocated once
+  std::size_t vertex_count = 0;
+  std::size_t index_count = 0;
+  for (auto primitive : primitives) {
+    std::size_t vertices = accessor(to_index((*primitive)["attributes"]["POSITION"])).count;
+    std::size_t const indices = to_index((*primitive)["indices"]);
+    vertex_count += vertices;
+    index_count += indices == none ? vertices : accessor(indices).count;
+  }
+  if (vertex_count > std::numeric_limits<GLuint>::max()) {
+    throw std::logic_error("model_loader: '" + path + "' has too many vertices for 32 bit indices");
+  }
+  std::vector<GLfloat> vertex_data(vertex_count * floats_per_vertex, 0.0f);
+  std::vector<GLuint> triangles(index_count);
+  std::vector<int> triangle_materials(index_count / 3);
+  bool without_material = false;
+
+  std::size_t base_vertex = 0;
+  std::size_t first_index = 0;
+  for (auto primitive : primitives) {
+    json::value const& primitive_attributes = (*primitive)["attributes"];
+    std::vector<accessor_data> data;
+    for (auto const& source : sources) {
+      data.push_back(accessor(to_index(primitive_attributes[source.name])));
+      if (data.back().count != data.front().count || data.back().components < source.components) {
+        throw std::logic_error(std::string{"model_loader: invalid "} + source.name + " accessor in '" + path + "'");
+      }
+    }
+    std::size_t const vertices = data.front().count;
+    GLfloat* out = vertex_data.data() + base_vertex * floats_per_vertex;
+
+    // interleaved floats in the model layout are copied at once
+    bool gpu_ready = data.front().data != nullptr && data.front().stride == vertex_bytes
+                  && (!has_normals || file_normals);
+    for (std::size_t a = 0; a < sources.size() && gpu_ready; ++a) {
+      gpu_ready = data[a].type == float_type && data[a].stride == vertex_bytes
+               && data[a].data == data.front().data + sources[a].offset * sizeof(GLfloat);
+    }
+    if (gpu_ready) {
+      std::memcpy(out, data.front().data, vertices * vertex_bytes);
+    }
+    else {
+      for (std::size_t a = 0; a < sources.size(); ++a) {
+        accessor_data const& attribute = data[a];
+        if (!attribute.data) continue;
+        std::size_t const component_size = component_bytes(attribute.type);
+        for (std::size_t v = 0; v < vertices; ++v) {
+          unsigned char const* element = attribute.data + v * attribute.stride;
+          GLfloat* target = out + v * floats_per_vertex + sources[a].offset;
+          for (std::size_t c = 0; c < sources[a].components; ++c) {
+            target[c] = read_component(element + c * component_size, attribute.type, attribute.normalized);
+          }
+        }
+      }
+    }
+
+    // indices are offset into the shared vertices
+    std::size_t const indices_index = to_index((*primitive)["indices"]);
+    std::size_t indices = vertices;
+    if (indices_index == none) {
+      for (std::size_t i = 0; i < vertices; ++i) {
+        triangles[first_index + i] = GLuint(base_vertex + i);
+      }
+    }
+    else {
+      accessor_data const index_data = accessor(indices_index);
+      if (!index_data.data || index_data.components != 1 || index_data.type == float_type || index_data.type == half_float_type) {
+        throw std::logic_error("model_loader: invalid index accessor in '" + path + "'");
+      }
+      indices = index_data.count;
+      std::size_t const component_size = component_bytes(index_data.type);
+      for (std::size_t i = 0; i < indices; ++i) {
+        std::uint32_t index = 0;
+        unsigned char const* element = index_data.data + i * index_data.stride;
+        if (component_size == 1) {
+          index = element[0];
+        }
+        else if (component_size == 2) {
+          std::uint16_t value;
+          std::memcpy(&value, element, sizeof(value));
+          index = value;
+        }
+        else {
+          std::memcpy(&index, element, sizeof(index));
+        }
+        if (index >= vertices) {
+          throw std::logic_error("model_loader: index out of range in '" + path + "'");
+        }
+        triangles[first_index + i] = GLuint(base_vertex + index);
+      }
+    }
+    if (indices % 3 != 0) {
+      throw std::logic_error("model_loader: incomplete triangle in '" + path + "'");
+    }
+
+    std::size_t const material_index = to_index((*primitive)["material"]);
+    int const material_id = material_index < document["materials"].size() ? int(material_index) : -1;
+    without_material = without_material || material_id < 0;
+    std::fill(triangle_materials.begin() + std::ptrdiff_t(first_index / 3),
+              triangle_materials.begin() + std::ptrdiff_t((first_index + indices) / 3), material_id);
+
+    base_vertex += vertices;
+    first_index += indices;
+  }
+
+  // generate normals by accumulating face normals like generate_normals
+  if (has_normals && !file_normals) {
+    std::vector<glm::fvec3> generated(vertex_count, glm::fvec3{0.0f});
+    for (std::size_t i = 0; i + 2 < index_count; i += 3) {
+      glm::fvec3 corners[3];
+      for (std::size_t c = 0; c < 3; ++c) {
+        corners[c] = glm::make_vec3(&vertex_data[triangles[i + c] * floats_per_vertex]);
+      }
+      glm::fvec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+      for (std::size_t c = 0; c < 3; ++c) {
+        generated[triangles[i + c]] += normal;
+      }
+    }
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+      glm::fvec3 normal = glm::length(generated[v]) > 0.0f ? glm::normalize(generated[v]) : generated[v];
+      std::copy(glm::value_ptr(normal), glm::value_ptr(normal) + 3, &vertex_data[v * floats_per_vertex + 3]);
+    }
+  }
+
+  model result{std::move(vertex_data), attributes, std::vector<GLuint>(index_count)};
+  for (auto const& source : document["materials"].elements) {
+    result.materials.push_back(convert_material(document, *source));
+  }
+  if (without_material) {
+    result.materials.push_back(material{"default", glm::fvec3{0.0f}, glm::fvec3{0.6f}, glm::fvec3{0.0f}, 1.0f, ""});
+  }
+  group_by_material(triangles.data(), triangle_materials.data(), index_count / 3, result.indices.data(), result);
+  return result;
 }
 
 void generate_normals(tinyobj::mesh_t& model) {
@@ -118,7 +1127,7 @@ void generate_normals(tinyobj::mesh_t& model) {
     normals[model.indices[i+2]] += normal;
   }
 
-  model.normals.reserve(model.positions.size());
+  model.normals.resize(model.positions.size());
   for (unsigned i = 0; i < normals.size(); ++i) {
     glm::fvec3 normal = glm::normalize(normals[i]);
     model.normals[i * 3] = normal[0];
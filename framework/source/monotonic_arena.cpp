@@ -0,0 +1,80 @@
+#include "monotonic_arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace {
+  // usable memory of a block starts after its header, keeping maximal alignment
+  const std::size_t header_bytes = (sizeof(void*) + sizeof(std::size_t) + 15) / 16 * 16;
+}
+
+monotonic_arena::monotonic_arena(std::size_t block_bytes)
+ :m_block_bytes{std::max(block_bytes, std::size_t(64))}
+ ,m_block{nullptr}
+ ,m_begin{nullptr}
+ ,m_end{nullptr}
+ ,m_block_allocations{0}
+ ,m_reserved_bytes{0}
+ ,m_peak_bytes{0}
+{}
+
+monotonic_arena::~monotonic_arena() {
+  release();
+}
+
+void* monotonic_arena::allocate(std::size_t bytes, std::size_t alignment) {
+  std::uintptr_t address = (std::uintptr_t(m_begin) + alignment - 1) / alignment * alignment;
+  if (m_block == nullptr || address + bytes > std::uintptr_t(m_end)) {
+    add_block(bytes + alignment);
+    address = (std::uintptr_t(m_begin) + alignment - 1) / alignment * alignment;
+  }
+  m_begin = reinterpret_cast<char*>(address + bytes);
+  return reinterpret_cast<void*>(address);
+}
+
+void monotonic_arena::reserve(std::size_t bytes) {
+  if (m_block == nullptr || std::size_t(m_end - m_begin) < bytes) {
+    add_block(bytes);
+  }
+}
+
+void monotonic_arena::release() {
+  while (m_block != nullptr) {
+    block* previous = m_block->previous;
+    ::operator delete(m_block);
+    m_block = previous;
+  }
+  m_begin = nullptr;
+  m_end = nullptr;
+  m_reserved_bytes = 0;
+}
+
+std::size_t monotonic_arena::block_allocations() const {
+  return m_block_allocations;
+}
+
+std::size_t monotonic_arena::reserved_bytes() const {
+  return m_reserved_bytes;
+}
+
+std::size_t monotonic_arena::peak_bytes() const {
+  return m_peak_bytes;
+}
+
+void monotonic_arena::add_block(std::size_t bytes) {
+  // oversized requests get a block of their own size, the rest shares regular blocks
+  std::size_t usable = std::max(bytes, m_block_bytes);
+  char* memory = static_cast<char*>(::operator new(header_bytes + usable));
+
+  block* added = reinterpret_cast<block*>(memory);
+  added->previous = m_block;
+  added->bytes = header_bytes + usable;
+  m_block = added;
+  m_begin = memory + header_bytes;
+  m_end = m_begin + usable;
+
+  ++m_block_allocations;
+  m_reserved_bytes += added->bytes;
+  m_peak_bytes = std::max(m_peak_bytes, m_reserved_bytes);
+}
@@ -0,0 +1,254 @@
+#include "procedural_mesh.hpp"
+
+#include "trace.hpp"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace procedural_mesh {
+
+namespace {
+  // levels above produce more than 2^32 indices
+  const unsigned max_level = 12;
+  // smaller work is not worth starting threads for
+  const std::size_t min_vertices_per_thread = 1 << 15;
+
+  // call function(begin, end) on contiguous parts of [0, count), each at least min_count long
+  template<typename Function>
+  void parallel_for(std::size_t count, std::size_t min_count, Function const& function) {
+    std::size_t threads = std::min(std::size_t(std::max(1u, std::thread::hardware_concurrency())),
+                                   count / std::max(min_count, std::size_t(1)));
+    if (threads <= 1) {
+      function(std::size_t(0), count);
+      return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (std::size_t t = 1; t < threads; ++t) {
+      workers.emplace_back(function, count * t / threads, count * (t + 1) / threads);
+    }
+    function(std::size_t(0), count / threads);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+  // floats per vertex of the attributes in model order
+  std::size_t vertex_floats(model::attrib_flag_t attributes) {
+    std::size_t floats = 0;
+    for (auto const& attribute : model::VERTEX_ATTRIBS) {
+      if (attribute.flag & attributes) floats += std::size_t(attribute.components);
+    }
+    return floats;
+  }
+
+  void check_level(unsigned level) {
+    if (level > max_level) {
+      throw std::logic_error("procedural_mesh: level " + std::to_string(level) + " exceeds " + std::to_string(max_level));
+    }
+  }
+}
+
+model uv_sphere(unsigned level, model::attrib_flag_t import_attribs) {
+  TRACE_SCOPE("procedural_mesh::uv_sphere");
+  check_level(level);
+  const float pi = glm::pi<float>();
+  std::size_t const rings = std::size_t(4) << level;
+  std::size_t const segments = std::size_t(8) << level;
+  model::attrib_flag_t const attributes{model::POSITION | import_attribs};
+  std::size_t const floats = vertex_floats(attributes);
+  std::size_t const row_vertices = segments + 1;
+
+  // ring r lies at latitude pi * (r / rings - 0.5) from south to north pole
+  std::vector<GLfloat> vertices((rings + 1) * row_vertices * floats);
+  parallel_for(rings + 1, min_vertices_per_thread / row_vertices + 1, [&](std::size_t begin, std::size_t end) {
+    GLfloat* out = &vertices[begin * row_vertices * floats];
+    for (std::size_t r = begin; r < end; ++r) {
+      float v = float(r) / float(rings);
+      float latitude = pi * (v - 0.5f);
+      for (std::size_t s = 0; s <= segments; ++s) {
+        float u = float(s) / float(segments);
+        float longitude = 2.0f * pi * (u - 0.5f);
+        glm::fvec3 normal{std::cos(latitude) * std::cos(longitude), std::sin(latitude),
+                          -std::cos(latitude) * std::sin(longitude)};
+        // derivatives along u and v
+        glm::fvec3 tangent{-std::sin(longitude), 0.0f, -std::cos(longitude)};
+        glm::fvec3 bitangent{-std::sin(latitude) * std::cos(longitude), std::cos(latitude),
+                             std::sin(latitude) * std::sin(longitude)};
+        // unit sphere, so position equals normal
+        *out++ = normal.x;
+        *out++ = normal.y;
+        *out++ = normal.z;
+        if (attributes & model::NORMAL) {
+          *out++ = normal.x;
+          *out++ = normal.y;
+          *out++ = normal.z;
+        }
+        if (attributes & model::TEXCOORD) {
+          *out++ = u;
+          *out++ = v;
+        }
+        if (attributes & model::TANGENT) {
+          *out++ = tangent.x;
+          *out++ = tangent.y;
+          *out++ = tangent.z;
+        }
+        if (attributes & model::BITANGENT) {
+          *out++ = bitangent.x;
+          *out++ = bitangent.y;
+          *out++ = bitangent.z;
+        }
+      }
+    }
+  });
+
+  // quads between rings, rows touching a pole collapse to one triangle per segment
+  std::size_t const triangles_per_segment = 2 * rings - 2;
+  std::vector<GLuint> triangles(segments * triangles_per_segment * 3);
+  parallel_for(rings, min_vertices_per_thread / row_vertices + 1, [&](std::size_t begin, std::size_t end) {
+    // rows before begin hold one triangle per segment at the south pole and two otherwise
+    std::size_t first = begin == 0 ? 0 : segments * (2 * begin - 1);
+    GLuint* out = &triangles[first * 3];
+    for (std::size_t r = begin; r < end; ++r) {
+      for (std::size_t s = 0; s < segments; ++s) {
+        GLuint lower = GLuint(r * row_vertices + s);
+        GLuint upper = GLuint((r + 1) * row_vertices + s);
+        // counter-clockwise seen from outside
+        if (r + 1 < rings) {
+          *out++ = lower;
+          *out++ = upper + 1;
+          *out++ = upper;
+        }
+        if (r > 0) {
+          *out++ = lower;
+          *out++ = lower + 1;
+          *out++ = upper + 1;
+        }
+      }
+    }
+  });
+
+  return model{std::move(vertices), attributes, std::move(triangles)};
+}
+
+model icosphere(unsigned level, model::attrib_flag_t import_attribs) {
+  TRACE_SCOPE("procedural_mesh::icosphere");
+  check_level(level);
+  model::attrib_flag_t attributes{model::POSITION | (import_attribs & model::NORMAL)};
+  if (import_attribs & (model::TEXCOORD | model::TANGENT | model::BITANGENT)) {
+    std::cerr << "Shape has no texcoords" << std::endl;
+  }
+  std::size_t const floats = vertex_floats(attributes);
+
+  // icosahedron with counter-clockwise faces
+  const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+  glm::fvec3 const corners[12] = {
+    {-1.0f, t, 0.0f}, {1.0f, t, 0.0f}, {-1.0f, -t, 0.0f}, {1.0f, -t, 0.0f},
+    {0.0f, -1.0f, t}, {0.0f, 1.0f, t}, {0.0f, -1.0f, -t}, {0.0f, 1.0f, -t},
+    {t, 0.0f, -1.0f}, {t, 0.0f, 1.0f}, {-t, 0.0f, -1.0f}, {-t, 0.0f, 1.0f}
+  };
+  unsigned const faces[20][3] = {
+    {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+    {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+    {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+    {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}
+  };
+
+  // vertices are numbered corners first, then the inner points of all
+  // edges and then the inner points of all faces, so every point is unique
+  std::size_t const parts = std::size_t(1) << level;
+  std::size_t const edge_inner = parts - 1;
+  std::size_t const face_inner = parts > 1 ? (parts - 1) * (parts - 2) / 2 : 0;
+  std::vector<std::pair<unsigned, unsigned>> edges;
+  for (auto const& face : faces) {
+    for (int e = 0; e < 3; ++e) {
+      std::pair<unsigned, unsigned> edge{std::min(face[e], face[(e + 1) % 3]), std::max(face[e], face[(e + 1) % 3])};
+      if (std::find(edges.begin(), edges.end(), edge) == edges.end()) edges.push_back(edge);
+    }
+  }
+  std::size_t const edge_base = 12;
+  std::size_t const face_base = edge_base + edges.size() * edge_inner;
+  std::size_t const vertex_count = face_base + 20 * face_inner;
+
+  std::vector<GLfloat> vertices(vertex_count * floats);
+  auto write_vertex = [&](std::size_t index, glm::fvec3 const& point) {
+    glm::fvec3 normal = glm::normalize(point);
+    GLfloat* out = &vertices[index * floats];
+    for (int repeat = 0; repeat < ((attributes & model::NORMAL) ? 2 : 1); ++repeat) {
+      *out++ = normal.x;
+      *out++ = normal.y;
+      *out++ = normal.z;
+    }
+  };
+  for (std::size_t c = 0; c < 12; ++c) {
+    write_vertex(c, corners[c]);
+  }
+  for (std::size_t e = 0; e < edges.size(); ++e) {
+    glm::fvec3 const& from = corners[edges[e].first];
+    glm::fvec3 const& to = corners[edges[e].second];
+    for (std::size_t k = 1; k < parts; ++k) {
+      write_vertex(edge_base + e * edge_inner + k - 1, from + (to - from) * (float(k) / float(parts)));
+    }
+  }
+
+  // index of grid point a + (b - a) i / parts + (c - a) j / parts of a face
+  auto grid_index = [&](std::size_t face, std::size_t i, std::size_t j) -> GLuint {
+    unsigned const* corner = faces[face];
+    auto on_edge = [&](unsigned from, unsigned to, std::size_t k) -> GLuint {
+      std::pair<unsigned, unsigned> edge{std::min(from, to), std::max(from, to)};
+      std::size_t e = std::size_t(std::find(edges.begin(), edges.end(), edge) - edges.begin());
+      std::size_t along = from < to ? k : parts - k;
+      return GLuint(edge_base + e * edge_inner + along - 1);
+    };
+    if (i == 0 && j == 0) return corner[0];
+    if (i == parts) return corner[1];
+    if (j == parts) return corner[2];
+    if (j == 0) return on_edge(corner[0], corner[1], i);
+    if (i == 0) return on_edge(corner[0], corner[2], j);
+    if (i + j == parts) return on_edge(corner[1], corner[2], j);
+    // inner points row by row, row j holds parts - j - 1 points
+    std::size_t before = (j - 1) * (parts - 1) - (j - 1) * j / 2;
+    return GLuint(face_base + face * face_inner + before + i - 1);
+  };
+
+  std::vector<GLuint> triangles(20 * parts * parts * 3);
+  parallel_for(20, min_vertices_per_thread / (parts * parts) + 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t face = begin; face < end; ++face) {
+      glm::fvec3 const& a = corners[faces[face][0]];
+      glm::fvec3 const& b = corners[faces[face][1]];
+      glm::fvec3 const& c = corners[faces[face][2]];
+      for (std::size_t j = 1; j < parts; ++j) {
+        for (std::size_t i = 1; i + j < parts; ++i) {
+          write_vertex(grid_index(face, i, j), a + (b - a) * (float(i) / float(parts)) + (c - a) * (float(j) / float(parts)));
+        }
+      }
+      // upward triangles and the downward ones between them, same winding as the face
+      GLuint* out = &triangles[face * parts * parts * 3];
+      for (std::size_t j = 0; j < parts; ++j) {
+        for (std::size_t i = 0; i + j < parts; ++i) {
+          *out++ = grid_index(face, i, j);
+          *out++ = grid_index(face, i + 1, j);
+          *out++ = grid_index(face, i, j + 1);
+          if (i + j + 1 < parts) {
+            *out++ = grid_index(face, i + 1, j);
+            *out++ = grid_index(face, i + 1, j + 1);
+            *out++ = grid_index(face, i, j + 1);
+          }
+        }
+      }
+    }
+  });
+
+  return model{std::move(vertices), attributes, std::move(triangles)};
+}
+
+}
@@ -0,0 +1,205 @@
+#include "profiler.hpp"
+#include "utils.hpp"
+
+#include <glbinding/gl/gl.h>
+// use gl definitions from glbinding 
+using namespace gl;
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+
+void profiler::sample_ring::push(double sample) {
+  samples[next % samples.size()] = sample;
+  ++next;
+}
+
+scope_stats profiler::sample_ring::stats() const {
+  scope_stats result{};
+  result.samples = std::min(next, samples.size());
+  if (result.samples == 0) {
+    return result;
+  }
+  result.last = samples[(next - 1) % samples.size()];
+
+  std::vector<double> sorted(samples.begin(), samples.begin() + result.samples);
+  std::sort(sorted.begin(), sorted.end());
+
+  result.min = sorted.front();
+  double sum = 0.0;
+  for (double sample : sorted) {
+    sum += sample;
+  }
+  result.avg = sum / double(sorted.size());
+  std::size_t p99_index = std::size_t(std::ceil(0.99 * double(sorted.size()))) - 1;
+  result.p99 = sorted[p99_index];
+
+  return result;
+}
+
+profiler::profiler(std::size_t history)
+ :m_history{history}
+ ,m_frame{0}
+ ,m_gpu_timing{-1}
+ ,m_scope_indices{}
+ ,m_scope_names{}
+ ,m_scopes{}
+ ,m_pending{}
+ ,m_free_queries{}
+{}
+
+profiler::~profiler() {
+  for (auto& frame : m_pending) {
+    for (auto const& pair : frame) {
+      m_free_queries.push_back(pair.begin);
+      m_free_queries.push_back(pair.end);
+    }
+  }
+  if (!m_free_queries.empty()) {
+    glDeleteQueries(GLsizei(m_free_queries.size()), m_free_queries.data());
+  }
+}
+
+void profiler::begin_frame() {
+  if (m_gpu_timing < 0) {
+    // timestamps are core since 3.3, the framework requests 3.2
+    m_gpu_timing = utils::has_extension("GL_ARB_timer_query") ? 1 : 0;
+  }
+
+  // queries of this slot were issued buffered_frames ago
+  auto& finished = m_pending[m_frame % buffered_frames];
+  for (auto const& pair : finished) {
+    GLint available = 0;
+    glGetQueryObjectiv(pair.end, GL_QUERY_RESULT_AVAILABLE, &available);
+    // never wait for the gpu, drop sample instead
+    if (available != 0) {
+      GLuint64 begin_time = 0;
+      GLuint64 end_time = 0;
+      glGetQueryObjectui64v(pair.begin, GL_QUERY_RESULT, &begin_time);
+      glGetQueryObjectui64v(pair.end, GL_QUERY_RESULT, &end_time);
+      m_scopes[pair.scope].gpu.push(double(end_time - begin_time) * 1.0e-6);
+    }
+    m_free_queries.push_back(pair.begin);
+    m_free_queries.push_back(pair.end);
+  }
+  finished.clear();
+}
+
+void profiler::end_frame() {
+  ++m_frame;
+}
+
+void profiler::begin(std::string const& name) {
+  auto iter = m_scope_indices.find(name);
+  if (iter == m_scope_indices.end()) {
+    iter = m_scope_indices.emplace(name, m_scopes.size()).first;
+    m_scope_names.push_back(name);
+    m_scopes.push_back(scope_data{});
+    m_scopes.back().cpu.samples.resize(m_history, 0.0);
+    m_scopes.back().gpu.samples.resize(m_history, 0.0);
+  }
+  scope_data& scope = m_scopes[iter->second];
+
+  if (m_gpu_timing > 0) {
+    auto& pending = m_pending[m_frame % buffered_frames];
+    scope.open_query = pending.size();
+    pending.push_back(query_pair{iter->second, acquire_query(), 0});
+    glQueryCounter(pending.back().begin, GL_TIMESTAMP);
+  }
+  scope.cpu_start = std::chrono::steady_clock::now();
+}
+
+void profiler::end(std::string const& name) {
+  auto end_time = std::chrono::steady_clock::now();
+  scope_data& scope = m_scopes.at(m_scope_indices.at(name));
+  scope.cpu.push(std::chrono::duration<double, std::milli>(end_time - scope.cpu_start).count());
+
+  if (m_gpu_timing > 0) {
+    query_pair& pair = m_pending[m_frame % buffered_frames].at(scope.open_query);
+    pair.end = acquire_query();
+    glQueryCounter(pair.end, GL_TIMESTAMP);
+  }
+}
+
+GLuint profiler::acquire_query() {
+  if (m_free_queries.empty()) {
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    return query;
+  }
+  GLuint query = m_free_queries.back();
+  m_free_queries.pop_back();
+  return query;
+}
+
+scope_stats profiler::cpu_stats(std::string const& name) const {
+  auto iter = m_scope_indices.find(name);
+  return iter == m_scope_indices.end() ? scope_stats{} : m_scopes[iter->second].cpu.stats();
+}
+
+scope_stats profiler::gpu_stats(std::string const& name) const {
+  auto iter = m_scope_indices.find(name);
+  return iter == m_scope_indices.end() ? scope_stats{} : m_scopes[iter->second].gpu.stats();
+}
+
+std::vector<std::string> profiler::scope_names() const {
+  return m_scope_names;
+}
+
+bool profiler::gpu_timing() const {
+  return m_gpu_timing > 0;
+}
+
+void profiler::print(std::ostream& os) const {
+  // restore the caller's formatting afterwards
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  os << std::fixed << std::setprecision(3);
+  os << std::left << std::setw(16) << "scope [ms]"
+     << " cpu min / avg / p99        gpu min / avg / p99" << std::endl;
+  for (auto const& name : m_scope_names) {
+    scope_stats cpu = cpu_stats(name);
+    scope_stats gpu = gpu_stats(name);
+    os << std::left << std::setw(16) << name
+       << " " << cpu.min << " / " << cpu.avg << " / " << cpu.p99;
+    if (gpu_timing()) {
+      os << "    " << gpu.min << " / " << gpu.avg << " / " << gpu.p99;
+    }
+    os << std::endl;
+  }
+  os.flags(flags);
+  os.precision(precision);
+}
+
+void print_stats_json(std::ostream& os, scope_stats const& stats) {
+  os << "{\"samples\": " << stats.samples
+     << ", \"min\": " << stats.min
+     << ", \"avg\": " << stats.avg
+     << ", \"p99\": " << stats.p99 << "}";
+}
+
+void profiler::print_json(std::ostream& os) const {
+  os << "{";
+  for (std::size_t i = 0; i < m_scope_names.size(); ++i) {
+    os << (i == 0 ? "" : ",") << "\n    \"" << m_scope_names[i] << "\": {\"cpu_ms\": ";
+    print_stats_json(os, m_scopes[i].cpu.stats());
+    if (gpu_timing()) {
+      os << ", \"gpu_ms\": ";
+      print_stats_json(os, m_scopes[i].gpu.stats());
+    }
+    os << "}";
+  }
+  os << "\n  }";
+}
+
+profile_scope::profile_scope(profiler& prof, std::string const& name)
+ :m_profiler(prof)
+ ,m_name{name}
+{
+  m_profiler.begin(m_name);
+}
+
+profile_scope::~profile_scope() {
+  m_profiler.end(m_name);
+}
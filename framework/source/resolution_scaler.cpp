@@ -0,0 +1,56 @@
+#include "resolution_scaler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// weight of a new frame time in the moving average
+const double smoothing = 0.1;
+// frames to let the average settle after a change
+const std::size_t settle_frames = 30;
+// tolerated deviation from the target before rescaling
+const double tolerance_over = 1.05;
+const double tolerance_under = 0.85;
+// smallest scale change worth applying
+const float min_change = 0.02f;
+
+resolution_scaler::resolution_scaler(double target, float min, float max)
+ :target_frame_time{target}
+ ,min_scale{min}
+ ,max_scale{max}
+ ,m_scale{max}
+ ,m_average_frame_time{target}
+ ,m_frames_since_change{0}
+{}
+
+float resolution_scaler::update(double frame_time) {
+  m_average_frame_time += smoothing * (frame_time - m_average_frame_time);
+  ++m_frames_since_change;
+
+  if (m_frames_since_change < settle_frames) {
+    return m_scale;
+  }
+
+  if (m_average_frame_time > target_frame_time * tolerance_over
+   || m_average_frame_time < target_frame_time * tolerance_under) {
+    // shading cost is proportional to the pixel count, so the square of the scale
+    float new_scale = m_scale * float(std::sqrt(target_frame_time / m_average_frame_time));
+    new_scale = std::min(std::max(new_scale, min_scale), max_scale);
+
+    if (std::abs(new_scale - m_scale) >= min_change) {
+      m_scale = new_scale;
+      // assume the new resolution hits the target until measured otherwise
+      m_average_frame_time = target_frame_time;
+      m_frames_since_change = 0;
+    }
+  }
+
+  return m_scale;
+}
+
+float resolution_scaler::scale() const {
+  return m_scale;
+}
+
+int resolution_scaler::scaled(int full_size) const {
+  return std::max(1, int(float(full_size) * m_scale));
+}
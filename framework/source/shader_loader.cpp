@@ -2,12 +2,14 @@
 #include "utils.hpp"
 
 #include <glbinding/gl/functions.h>
+#include <glbinding/ProcAddress.h>
 // use gl definitions from glbinding 
 using namespace gl;
 
 namespace shader_loader {
 
-GLuint shader(std::string const& file_path, GLenum shader_type) {
+// create shader and start compilation without waiting for the result
+GLuint submit_shader(std::string const& file_path, GLenum shader_type) {
   GLuint shader = 0;
   shader = glCreateShader(shader_type);
 
@@ -18,7 +20,11 @@ GLuint shader(std::string const& file_path, GLenum shader_type) {
 
   glCompileShader(shader);
 
-  // check if compilation was successfull
+  return shader;
+}
+
+// check if compilation was successfull, output log and return false if not
+bool shader_compiled(GLuint shader, std::string const& file_path) {
   GLint success = 0;
   glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
   if(success == 0) {
@@ -30,30 +36,13 @@ GLuint shader(std::string const& file_path, GLenum shader_type) {
     glGetShaderInfoLog(shader, log_size, &log_size, log_buffer);
     // output errors
     utils::output_log(log_buffer, utils::file_name(file_path));
-    // free broken shader
-    glDeleteShader(shader);
     free(log_buffer);
-
-    throw std::logic_error("Compilation of " + file_path);
   }
-
-  return shader;
+  return success != 0;
 }
 
-GLuint program(std::string const& vertex_path, std::string const& fragment_path) {
-  GLuint program = glCreateProgram();
-
-  // load and compile vert and frag shader
-  GLuint vertex_shader = shader(vertex_path, GL_VERTEX_SHADER);
-  GLuint fragment_shader = shader(fragment_path, GL_FRAGMENT_SHADER);
-
-  // attach the shaders to the program
-  glAttachShader(program, vertex_shader);
-  glAttachShader(program, fragment_shader);
-  // link shaders
-  glLinkProgram(program);
-
-  // check if linking was successfull
+// check if linking was successfull, output log and return false if not
+bool program_linked(GLuint program, std::string const& log_prefix) {
   GLint success = 0;
   glGetProgramiv(program, GL_LINK_STATUS, &success);
   if(success == 0) {
@@ -64,21 +53,46 @@ GLuint program(std::string const& vertex_path, std::string const& fragment_path)
     GLchar* log_buffer = (GLchar*)malloc(sizeof(GLchar) * log_size);
     glGetProgramInfoLog(program, log_size, &log_size, log_buffer);
     // output errors
-    utils::output_log(log_buffer, utils::file_name(vertex_path) + " & " + utils::file_name(fragment_path));
-    // free broken program
-    glDeleteProgram(program);
+    utils::output_log(log_buffer, log_prefix);
     free(log_buffer);
+  }
+  return success != 0;
+}
 
-    throw std::logic_error("Linking of " + vertex_path + " & " + fragment_path);
+// let the driver compile on as many threads as it likes
+void enable_parallel_compile() {
+  static bool requested = false;
+  if (requested) return;
+  requested = true;
+  if (utils::has_extension("GL_ARB_parallel_shader_compile")) {
+    glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
   }
-  // detach shaders
-  glDetachShader(program, vertex_shader);
-  glDetachShader(program, fragment_shader);
-  // and free them
-  glDeleteShader(vertex_shader);
-  glDeleteShader(fragment_shader);
+  else if (utils::has_extension("GL_KHR_parallel_shader_compile")) {
+    // glbinding does not know the KHR entry point, it shares enums and semantics with ARB
+    typedef void (GL_APIENTRY *max_threads_function)(GLuint count);
+    max_threads_function max_threads =
+      reinterpret_cast<max_threads_function>(glbinding::getProcAddress("glMaxShaderCompilerThreadsKHR"));
+    if (max_threads) {
+      max_threads(0xFFFFFFFF);
+    }
+  }
+}
 
-  return program;
+GLuint shader(std::string const& file_path, GLenum shader_type) {
+  GLuint shader = submit_shader(file_path, shader_type);
+
+  if(!shader_compiled(shader, file_path)) {
+    // free broken shader
+    glDeleteShader(shader);
+
+    throw std::logic_error("Compilation of " + file_path);
+  }
+
+  return shader;
+}
+
+GLuint program(std::string const& vertex_path, std::string const& fragment_path) {
+  return programs({program_paths{vertex_path, fragment_path}}).front();
 }
 
 GLuint program(std::string const& vertex_path, std::string const& geometry_path, std::string const& fragment_path) {
@@ -126,4 +140,62 @@ GLuint program(std::string const& vertex_path, std::string const& geometry_path,
   return program;
 }
 
+std::vector<GLuint> programs(std::vector<program_paths> const& paths) {
+  enable_parallel_compile();
+
+  std::vector<GLuint> programs(paths.size(), 0);
+  std::vector<GLuint> vertex_shaders(paths.size(), 0);
+  std::vector<GLuint> fragment_shaders(paths.size(), 0);
+
+  // submit all compilations first, the driver may work on them concurrently
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    vertex_shaders[i] = submit_shader(paths[i].first, GL_VERTEX_SHADER);
+    fragment_shaders[i] = submit_shader(paths[i].second, GL_FRAGMENT_SHADER);
+  }
+  // then submit all links, failed compilations just cause failed links
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    programs[i] = glCreateProgram();
+    // attach the shaders to the program
+    glAttachShader(programs[i], vertex_shaders[i]);
+    glAttachShader(programs[i], fragment_shaders[i]);
+    // link shaders
+    glLinkProgram(programs[i]);
+  }
+
+  // only now wait for the results, report all errors at once
+  std::string error{};
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    bool vertex_ok = shader_compiled(vertex_shaders[i], paths[i].first);
+    bool fragment_ok = shader_compiled(fragment_shaders[i], paths[i].second);
+    if (!vertex_ok && error.empty()) {
+      error = "Compilation of " + paths[i].first;
+    }
+    else if (!fragment_ok && error.empty()) {
+      error = "Compilation of " + paths[i].second;
+    }
+    // link log is meaningless if a stage did not compile
+    else if (vertex_ok && fragment_ok
+     && !program_linked(programs[i], utils::file_name(paths[i].first) + " & " + utils::file_name(paths[i].second))
+     && error.empty()) {
+      error = "Linking of " + paths[i].first + " & " + paths[i].second;
+    }
+    // detach shaders
+    glDetachShader(programs[i], vertex_shaders[i]);
+    glDetachShader(programs[i], fragment_shaders[i]);
+    // and free them
+    glDeleteShader(vertex_shaders[i]);
+    glDeleteShader(fragment_shaders[i]);
+  }
+
+  if (!error.empty()) {
+    // free all programs of the batch
+    for (auto program : programs) {
+      glDeleteProgram(program);
+    }
+    throw std::logic_error(error);
+  }
+
+  return programs;
+}
+
 };
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "startup.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace {
+  typedef std::chrono::steady_clock clock;
+  // set during static initialization, closest to process start we can get
+  const clock::time_point launch_time = clock::now();
+
+  struct entry {
+    std::string name;
+    // span from first beginning to last end in seconds since launch
+    double first_begin;
+    double last_end;
+    // summed duration, exceeds the span if occurrences overlapped
+    double total;
+    std::size_t count;
+  };
+
+  std::mutex entries_mutex;
+  std::vector<entry> entries;
+
+  std::vector<entry> sorted_entries() {
+    std::vector<entry> sorted{};
+    {
+      std::lock_guard<std::mutex> lock{entries_mutex};
+      sorted = entries;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](entry const& a, entry const& b) {
+      return a.first_begin < b.first_begin;
+    });
+    return sorted;
+  }
+}
+
+namespace startup {
+
+double elapsed() {
+  return std::chrono::duration<double>(clock::now() - launch_time).count();
+}
+
+void record(std::string const& name, double begin, double end) {
+  std::lock_guard<std::mutex> lock{entries_mutex};
+  auto existing = std::find_if(entries.begin(), entries.end(), [&name](entry const& e) {
+    return e.name == name;
+  });
+  if (existing == entries.end()) {
+    entries.push_back(entry{name, begin, end, end - begin, 1});
+  }
+  else {
+    existing->first_begin = std::min(existing->first_begin, begin);
+    existing->last_end = std::max(existing->last_end, end);
+    existing->total += end - begin;
+    ++existing->count;
+  }
+}
+
+void mark(std::string const& name) {
+  double now = elapsed();
+  record(name, now, now);
+}
+
+void print(std::ostream& os) {
+  std::ios::fmtflags flags{os.flags()};
+  os << "Startup (ms since launch):\n"
+     << std::left << std::setw(28) << "  phase" << std::right
+     << std::setw(10) << "begin" << std::setw(10) << "end"
+     << std::setw(10) << "total" << std::setw(7) << "count" << "\n"
+     << std::fixed << std::setprecision(2);
+  for (auto const& e : sorted_entries()) {
+    os << "  " << std::left << std::setw(26) << e.name << std::right
+       << std::setw(10) << e.first_begin * 1000.0 << std::setw(10) << e.last_end * 1000.0
+       << std::setw(10) << e.total * 1000.0 << std::setw(7) << e.count << "\n";
+  }
+  os.flags(flags);
+  os << std::flush;
+}
+
+void print_json(std::ostream& os) {
+  os << "[";
+  std::vector<entry> sorted{sorted_entries()};
+  for (std::size_t i = 0; i < sorted.size(); ++i) {
+    entry const& e = sorted[i];
+    os << (i == 0 ? "" : ",") << "\n    {\"phase\": \"" << e.name << "\""
+       << ", \"begin_ms\": " << e.first_begin * 1000.0
+       << ", \"end_ms\": " << e.last_end * 1000.0
+       << ", \"total_ms\": " << e.total * 1000.0
+       << ", \"count\": " << e.count << "}";
+  }
+  os << "\n  ]";
+}
+
+phase::phase(std::string const& name)
+ :m_name{name}
+ ,m_begin{elapsed()}
+{}
+
+phase::~phase() {
+  record(m_name, m_begin, elapsed());
+}
+
+};
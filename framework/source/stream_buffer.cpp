@@ -0,0 +1,142 @@
+#include "stream_buffer.hpp"
+
+#include "memory_tracker.hpp"
+#include "utils.hpp"
+
+#include <glbinding/gl/gl.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+  // poll fences in steps of 1 ms
+  const GLuint64 wait_timeout = 1000000;
+}
+
+stream_buffer::stream_buffer(std::size_t region_bytes, std::string const& owner, std::size_t regions)
+ :m_owner{owner}
+ ,m_persistent{utils::has_extension("GL_ARB_buffer_storage")}
+ ,m_region_bytes{std::max(region_bytes, std::size_t(1))}
+ ,m_region{0}
+ ,m_used{0}
+ ,m_stalls{0}
+ ,m_buffer{0}
+ ,m_generation{0}
+ ,m_mapped{nullptr}
+ ,m_fences(std::max(regions, std::size_t(1)), nullptr)
+{
+  allocate();
+}
+
+stream_buffer::~stream_buffer() {
+  release();
+}
+
+void stream_buffer::begin_frame(std::size_t reserve_bytes) {
+  if (reserve_bytes > m_region_bytes) {
+    release();
+    m_region_bytes = std::max(reserve_bytes, m_region_bytes * 2);
+    allocate();
+  }
+  m_region = (m_region + 1) % m_fences.size();
+  if (m_fences[m_region] && !wait(m_fences[m_region])) {
+    throw std::runtime_error("stream_buffer: waiting for fence of '" + m_owner + "' failed");
+  }
+  m_used = 0;
+}
+
+std::size_t stream_buffer::write(void const* data, std::size_t bytes, std::size_t alignment) {
+  std::size_t start = (m_used + alignment - 1) / alignment * alignment;
+  if (start + bytes > m_region_bytes) {
+    throw std::runtime_error("stream_buffer: frame data of '" + m_owner + "' exceeds region, reserve it in begin_frame");
+  }
+  std::size_t offset = m_region * m_region_bytes + start;
+
+  if (m_persistent) {
+    std::memcpy(m_mapped + offset, data, bytes);
+  }
+  else {
+    // fences guarantee the range is unused, so the driver need not synchronize
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    void* mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, GLintptr(offset), GLsizeiptr(bytes),
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!mapped) {
+      throw std::runtime_error("stream_buffer: mapping region of '" + m_owner + "' failed");
+    }
+    std::memcpy(mapped, data, bytes);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  }
+  m_used = start + bytes;
+  return offset;
+}
+
+void stream_buffer::end_frame() {
+  m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, UnusedMask::GL_NONE_BIT);
+}
+
+GLuint stream_buffer::buffer() const {
+  return m_buffer;
+}
+
+std::size_t stream_buffer::generation() const {
+  return m_generation;
+}
+
+bool stream_buffer::persistent() const {
+  return m_persistent;
+}
+
+std::size_t stream_buffer::stalls() const {
+  return m_stalls;
+}
+
+void stream_buffer::allocate() {
+  std::size_t bytes = m_region_bytes * m_fences.size();
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+  if (m_persistent) {
+    // coherent mapping makes writes visible without explicit flushes
+    glBufferStorage(GL_COPY_WRITE_BUFFER, GLsizeiptr(bytes), NULL,
+                    BufferStorageMask::GL_MAP_WRITE_BIT | BufferStorageMask::GL_MAP_PERSISTENT_BIT | BufferStorageMask::GL_MAP_COHERENT_BIT);
+    m_mapped = static_cast<std::uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, GLsizeiptr(bytes),
+                                          GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT));
+    if (!m_mapped) {
+      throw std::runtime_error("stream_buffer: mapping storage of '" + m_owner + "' failed");
+    }
+  }
+  else {
+    glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(bytes), NULL, GL_STREAM_DRAW);
+  }
+  MEMORY_TRACK(buffer, m_buffer, bytes, m_owner);
+  ++m_generation;
+}
+
+void stream_buffer::release() {
+  for (auto& fence : m_fences) {
+    if (fence) {
+      wait(fence);
+    }
+  }
+  if (m_persistent) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    m_mapped = nullptr;
+  }
+  glDeleteBuffers(1, &m_buffer);
+  MEMORY_RELEASE(buffer, m_buffer);
+  m_buffer = 0;
+}
+
+bool stream_buffer::wait(GLsync& fence) {
+  GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+  if (result == GL_TIMEOUT_EXPIRED) {
+    ++m_stalls;
+    do {
+      result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait_timeout);
+    } while (result == GL_TIMEOUT_EXPIRED);
+  }
+  glDeleteSync(fence);
+  fence = nullptr;
+  return result != GL_WAIT_FAILED;
+}
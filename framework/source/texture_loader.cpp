@@ -1,4 +1,5 @@
 #include "texture_loader.hpp"
+#include "trace.hpp"
 
 // request supported types
 #define STBI_ONLY_JPEG
@@ -17,11 +18,13 @@
 
 namespace texture_loader {
 pixel_data file(std::string const& file_name) {
+  TRACE_SCOPE("texture_loader::file");
   uint8_t* data_ptr;
   int width = 0;
   int height = 0;
   int format = STBI_default;
-  data_ptr = stbi_load(file_name.c_str(), &width, &height, &format, STBI_rgb_alpha);
+  // keep channels of the file, so the data matches the reported format
+  data_ptr = stbi_load(file_name.c_str(), &width, &height, &format, STBI_default);
 
   if(!data_ptr) {
     throw std::logic_error(std::string{"stb_image: "} + stbi_failure_reason());
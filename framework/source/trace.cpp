@@ -0,0 +1,149 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+// events per thread, older ones are overwritten
+const std::size_t buffer_capacity = 1 << 16;
+
+struct event {
+  char const* name;
+  std::uint64_t nanoseconds;
+  char phase;
+};
+
+// ring slot, fields are atomic because dump may read a slot the owner is overwriting
+struct slot {
+  std::atomic<char const*> name;
+  std::atomic<std::uint64_t> nanoseconds;
+  std::atomic<char> phase;
+};
+
+// written only by its owning thread, read when dumping
+struct thread_buffer {
+  thread_buffer(std::size_t id)
+   :thread_id{id}
+   ,thread_name{nullptr}
+   ,events(buffer_capacity)
+   ,written{0}
+  {}
+
+  std::size_t thread_id;
+  std::atomic<char const*> thread_name;
+  std::vector<slot> events;
+  // total number of recorded events, published with release semantics
+  std::atomic<std::size_t> written;
+};
+
+// all buffers ever created, locked only when a thread records its first event
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<thread_buffer>> registry;
+
+std::chrono::steady_clock::time_point const start_time = std::chrono::steady_clock::now();
+
+thread_buffer& local_buffer() {
+  thread_local thread_buffer* buffer = nullptr;
+  if (!buffer) {
+    std::lock_guard<std::mutex> lock{registry_mutex};
+    registry.emplace_back(new thread_buffer{registry.size()});
+    buffer = registry.back().get();
+  }
+  return *buffer;
+}
+
+void record(char const* name, char phase) {
+  thread_buffer& buffer = local_buffer();
+  std::uint64_t now = std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
+
+  std::size_t index = buffer.written.load(std::memory_order_relaxed);
+  slot& s = buffer.events[index % buffer_capacity];
+  // a dump that sees any of the stores below also sees the previous written count
+  std::atomic_thread_fence(std::memory_order_release);
+  s.name.store(name, std::memory_order_relaxed);
+  s.nanoseconds.store(now, std::memory_order_relaxed);
+  s.phase.store(phase, std::memory_order_relaxed);
+  buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void begin(char const* name) {
+  record(name, 'B');
+}
+
+void end(char const* name) {
+  record(name, 'E');
+}
+
+void set_thread_name(char const* name) {
+  local_buffer().thread_name.store(name, std::memory_order_relaxed);
+}
+
+bool dump(std::string const& file_path) {
+  std::ofstream file{file_path};
+  if (!file) {
+    std::cerr << "File \'" << file_path << "\' could not be opened" << std::endl;
+    return false;
+  }
+
+  file << "{\"traceEvents\":[";
+  bool first = true;
+
+  std::lock_guard<std::mutex> lock{registry_mutex};
+  for (auto const& buffer : registry) {
+    std::size_t written = buffer->written.load(std::memory_order_acquire);
+    std::size_t oldest = written > buffer_capacity ? written - buffer_capacity : 0;
+    std::vector<event> events{};
+    events.reserve(written - oldest);
+    for (std::size_t i = oldest; i < written; ++i) {
+      slot const& s = buffer->events[i % buffer_capacity];
+      events.push_back(event{s.name.load(std::memory_order_relaxed),
+                             s.nanoseconds.load(std::memory_order_relaxed),
+                             s.phase.load(std::memory_order_relaxed)});
+    }
+    // drop slots the owner started overwriting while they were copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    std::size_t overwritten = buffer->written.load(std::memory_order_relaxed);
+    std::size_t first_valid = overwritten >= buffer_capacity ? overwritten - buffer_capacity + 1 : 0;
+    if (first_valid > oldest) {
+      events.erase(events.begin(), events.begin() + std::min(first_valid - oldest, events.size()));
+    }
+    // end events whose begin was overwritten would corrupt the nesting
+    std::size_t depth = 0;
+
+    char const* thread_name = buffer->thread_name.load(std::memory_order_relaxed);
+    if (thread_name) {
+      file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+           << buffer->thread_id << ",\"args\":{\"name\":\"" << thread_name << "\"}}";
+      first = false;
+    }
+
+    for (event const& e : events) {
+      if (e.phase == 'B') {
+        ++depth;
+      }
+      else if (depth == 0) {
+        continue;
+      }
+      else {
+        --depth;
+      }
+      file << (first ? "" : ",") << "\n{\"name\":\"" << e.name << "\",\"ph\":\"" << e.phase
+           << "\",\"pid\":1,\"tid\":" << buffer->thread_id
+           << ",\"ts\":" << e.nanoseconds / 1000 << "." << (e.nanoseconds % 1000) / 100 << "}";
+      first = false;
+    }
+  }
+  file << "\n]}\n";
+
+  std::cout << "Trace written to \'" << file_path << "\'" << std::endl;
+  return true;
+}
+
+};
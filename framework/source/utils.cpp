@@ -6,20 +6,111 @@
 // use gl definitions from glbinding 
 using namespace gl;
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <fstream>
 
 namespace utils {
 
-texture_object create_texture_object(pixel_data const& tex) {
+texture_object create_texture_object(pixel_data const& tex, float max_anisotropy) {
   texture_object t_obj{};
-
-  throw std::logic_error("Texture Object creation not implemented yet");
+  t_obj.target = tex.depth > 1 ? GL_TEXTURE_3D : GL_TEXTURE_2D;
+
+  glGenTextures(1, &t_obj.handle);
+  glBindTexture(t_obj.target, t_obj.handle);
+  allocate_texture_storage(t_obj.target, mip_levels(tex.width, tex.height, tex.depth),
+                           sized_format(tex.channels, tex.channel_type), tex.width, tex.height, tex.depth);
+
+  // rows of rgb images are not padded to 4 bytes
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  if (t_obj.target == GL_TEXTURE_3D) {
+    glTexSubImage3D(t_obj.target, 0, 0, 0, 0, GLsizei(tex.width), GLsizei(tex.height), GLsizei(tex.depth),
+                    tex.channels, tex.channel_type, tex.ptr());
+  }
+  else {
+    glTexSubImage2D(t_obj.target, 0, 0, 0, GLsizei(tex.width), GLsizei(tex.height),
+                    tex.channels, tex.channel_type, tex.ptr());
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  // smaller levels are filtered from the image on the gpu
+  glGenerateMipmap(t_obj.target);
+  set_mipmap_filtering(t_obj.target, max_anisotropy);
 
   return t_obj;
 }
 
+GLsizei mip_levels(std::size_t width, std::size_t height, std::size_t depth) {
+  std::size_t size = std::max(width, std::max(height, depth));
+  GLsizei levels = 1;
+  while (size > 1) {
+    size /= 2;
+    ++levels;
+  }
+  return levels;
+}
+
+GLenum sized_format(GLenum channels, GLenum channel_type) {
+  // rows by channel count, columns by normalized bytes, half and full floats
+  GLenum const formats[4][3] = {{GL_R8, GL_R16F, GL_R32F}, {GL_RG8, GL_RG16F, GL_RG32F},
+                                {GL_RGB8, GL_RGB16F, GL_RGB32F}, {GL_RGBA8, GL_RGBA16F, GL_RGBA32F}};
+  std::size_t row = 3;
+  if (channels == GL_RED) row = 0;
+  else if (channels == GL_RG) row = 1;
+  else if (channels == GL_RGB || channels == GL_BGR) row = 2;
+  std::size_t column = 0;
+  if (channel_type == GL_HALF_FLOAT) column = 1;
+  else if (channel_type == GL_FLOAT) column = 2;
+  return formats[row][column];
+}
+
+void allocate_texture_storage(GLenum target, GLsizei levels, GLenum internal_format,
+                              std::size_t width, std::size_t height, std::size_t depth) {
+  GLsizei w = GLsizei(width);
+  GLsizei h = GLsizei(height);
+  GLsizei d = GLsizei(depth);
+  bool const volume = target == GL_TEXTURE_3D || target == GL_TEXTURE_2D_ARRAY;
+  // immutable storage lets the driver skip completeness checks on every draw
+  static bool const immutable = has_extension("GL_ARB_texture_storage");
+  if (immutable) {
+    if (volume) {
+      glTexStorage3D(target, levels, internal_format, w, h, d);
+    }
+    else {
+      glTexStorage2D(target, levels, internal_format, w, h);
+    }
+    return;
+  }
+
+  // specify every level, sampling would fail with missing ones
+  for (GLint level = 0; level < levels; ++level) {
+    if (volume) {
+      glTexImage3D(target, level, GLint(internal_format), w, h, d, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+    }
+    else {
+      glTexImage2D(target, level, GLint(internal_format), w, h, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+    }
+    w = std::max(w / 2, 1);
+    if (target != GL_TEXTURE_1D_ARRAY) h = std::max(h / 2, 1);
+    if (target == GL_TEXTURE_3D) d = std::max(d / 2, 1);
+  }
+  glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+}
+
+void set_mipmap_filtering(GLenum target, float max_anisotropy) {
+  glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GLint(GL_LINEAR_MIPMAP_LINEAR));
+  glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GLint(GL_LINEAR));
+
+  // anisotropy is only core since 4.6, clamp it to the supported maximum
+  static bool const anisotropic = has_extension("GL_EXT_texture_filter_anisotropic")
+                               || has_extension("GL_ARB_texture_filter_anisotropic");
+  if (anisotropic && max_anisotropy > 1.0f) {
+    GLfloat supported = 1.0f;
+    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &supported);
+    glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(max_anisotropy, supported));
+  }
+}
+
 void print_bound_textures() {
   GLint id1, id2, id3, active_unit, texture_units = 0;
   glGetIntegerv(GL_ACTIVE_TEXTURE, &active_unit);
@@ -89,6 +180,19 @@ GLint get_bound_VAO() {
   return array;
 }
 
+bool has_extension(std::string const& name) {
+  GLint num_extensions = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+
+  for(GLint i = 0; i < num_extensions; ++i) {
+    char const* extension = reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, GLuint(i)));
+    if (name == extension) {
+      return true;
+    }
+  }
+  return false;
+}
+
 std::string file_name(std::string const& file_path) {
   return file_path.substr(file_path.find_last_of("/\\") + 1);
 }
@@ -2,6 +2,8 @@
 
 uniform sampler2D ColorTex;
 uniform vec2 Resolution;
+// part of the texture covered by the rendered scene
+uniform vec2 ResolutionScale;
 
 uniform bool GreyscaleActive;
 uniform bool FlipHorizontalActive;
@@ -42,6 +44,8 @@ vec4 gaussian_smooth (vec2 texCoords)
 
             vec2 offset = vec2(float(x), float(y));
             vec2 texCoord = texCoords + offset * inv_resolution;
+            // dont sample outside of the rendered sub-rect
+            texCoord = clamp(texCoord, vec2(0.0), ResolutionScale - 0.5 * inv_resolution);
             vec4 cl = texture(ColorTex, texCoord);
 
             sum += factor * cl;
@@ -65,6 +69,10 @@ void main(void)
         texCoords = flip_horizontal(texCoords);
     }
 
+    // map screen to rendered sub-rect, bilinear filtering upscales
+    // stay half a texel inside so stale texels outside are never filtered in
+    texCoords = min(texCoords * ResolutionScale, ResolutionScale - 0.5 / Resolution);
+
     vec4 color = vec4(0.0f);
     if (GaussianSmoothActive)
     {
@@ -7,6 +7,7 @@ in vec3 normalInt;
 in vec3 vertPos;
 in vec3 sunPos;
 in vec2 pass_TexCoord;
+flat in float pass_Layer;
 
 out vec4 out_Color;
 
@@ -15,7 +16,8 @@ out vec4 out_Color;
 const vec3 specColor = vec3(1.0, 1.0, 1.0);
 const float shininess = 16.0;
 
-uniform sampler2D Texture;
+//Texture of every body in its own layer
+uniform sampler2DArray Textures;
 
 void main(void)
 {
@@ -37,7 +39,12 @@ void main(void)
 		specular = pow(specAngle, shininess);	
 	}
 
-	vec3 TextureColor = (texture(Texture, pass_TexCoord)).rgb;
+	//Negative layer means not loaded yet, body is shown in its color
+	vec3 TextureColor = pass_Color;
+	if (pass_Layer >= 0.0)
+	{
+		TextureColor = (texture(Textures, vec3(pass_TexCoord, pass_Layer))).rgb;
+	}
 
 	vec3 colorLinear = vec3(0.1f) * TextureColor + lambertian * TextureColor + specular * specColor;
 
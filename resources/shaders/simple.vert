@@ -4,13 +4,16 @@
 layout(location=0) in vec3 in_Position;
 layout(location=1) in vec3 in_Normal;
 layout(location=2) in vec2 in_Texcoord;
+// index of the draw in its batch
+layout(location=3) in uint in_DrawID;
 
 //Matrix Uniforms as specified with glUniformMatrix4fv
-uniform mat4 ModelMatrix;
 uniform mat4 ViewMatrix;
 uniform mat4 ProjectionMatrix;
-uniform mat4 NormalMatrix;
-uniform vec3 ColorVec;
+//Per draw model matrix, normal matrix and color with texture layer
+uniform samplerBuffer DrawParameters;
+//First texel of this frame in DrawParameters
+uniform int DrawParameterOffset;
 
 
 out vec4 pass_Normal;
@@ -19,9 +22,17 @@ out vec3 normalInt;
 out vec3 pass_Color;
 out vec3 sunPos;
 out vec2 pass_TexCoord;
+flat out float pass_Layer;
 
 void main(void)
 {
+	int base = DrawParameterOffset + int(in_DrawID) * 9;
+	mat4 ModelMatrix = mat4(texelFetch(DrawParameters, base), texelFetch(DrawParameters, base + 1),
+	                        texelFetch(DrawParameters, base + 2), texelFetch(DrawParameters, base + 3));
+	mat4 NormalMatrix = mat4(texelFetch(DrawParameters, base + 4), texelFetch(DrawParameters, base + 5),
+	                         texelFetch(DrawParameters, base + 6), texelFetch(DrawParameters, base + 7));
+	vec4 ColorLayer = texelFetch(DrawParameters, base + 8);
+
 	gl_Position = (ProjectionMatrix  * ViewMatrix * ModelMatrix) * vec4(in_Position, 1.0f);
 
 	vec4 vertPos4 = ModelMatrix * vec4(in_Position, 1.0);
@@ -30,6 +41,7 @@ void main(void)
     sunPos = vec3((ViewMatrix) * vec4(vec3(0.0,0.0,0.0), 1.0f));
 
 	normalInt = vec3(NormalMatrix * vec4(in_Normal, 0.0));
-	pass_Color = ColorVec;
+	pass_Color = ColorLayer.rgb;
+	pass_Layer = ColorLayer.a;
 	pass_TexCoord = in_Texcoord;
 }
\ No newline at end of file
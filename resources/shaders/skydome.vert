@@ -10,6 +10,8 @@ uniform mat4 ModelMatrix;
 uniform mat4 ViewMatrix;
 uniform mat4 ProjectionMatrix;
 uniform mat4 NormalMatrix;
+// project onto far plane, drawn after all other geometry
+uniform bool FarPlaneActive;
 
 out vec3 pass_Normal;
 out vec2 pass_TexCoord;
@@ -17,6 +19,10 @@ out vec2 pass_TexCoord;
 void main(void)
 {
 	gl_Position = (ProjectionMatrix  * ViewMatrix * ModelMatrix) * vec4(in_Position, 1.0);
+	if (FarPlaneActive) {
+		// depth is z / w, so every fragment ends up at 1.0
+		gl_Position.z = gl_Position.w;
+	}
 	pass_Normal = (NormalMatrix * vec4(in_Normal, 0.0)).xyz;
 	pass_TexCoord = in_Texcoord;
 }
\ No newline at end of file
@@ -1,16 +1,51 @@
 #version 150
-#extension GL_ARB_explicit_attrib_location : require
-// Star Shader
-layout(location=0) in vec3 in_Position;
-layout(location=1) in vec3 in_Color;
+// Star Shader, stars are generated from their index without vertex attributes
 
 uniform mat4 ViewMatrix;
 uniform mat4 ProjectionMatrix;
+// same seed gives the same star field
+uniform uint Seed;
+// minimal and maximal distance of stars from the origin
+uniform vec2 Distances;
 
 out vec3 pass_Color;
 
+const float PI = 3.14159265;
+
+// integer hash with good avalanche behaviour
+uint hash(uint x)
+{
+	x ^= x >> 16u;
+	x *= 0x7feb352du;
+	x ^= x >> 15u;
+	x *= 0x846ca68bu;
+	x ^= x >> 16u;
+	return x;
+}
+
+// advance state and return uniform value in [0, 1)
+float random(inout uint state)
+{
+	state = hash(state);
+	return float(state >> 8u) * (1.0 / 16777216.0);
+}
+
 void main(void)
 {
-	gl_Position = (ProjectionMatrix  * ViewMatrix) * vec4(in_Position, 1.0f);
-	pass_Color = in_Color;
+	uint state = hash(uint(gl_VertexID) ^ hash(Seed));
+
+	// uniform direction on the unit sphere
+	float z = random(state) * 2.0 - 1.0;
+	float phi = random(state) * 2.0 * PI;
+	vec3 direction = vec3(sqrt(1.0 - z * z) * vec2(cos(phi), sin(phi)), z);
+	// uniform density within the shell
+	vec2 cubes = Distances * Distances * Distances;
+	float radius = pow(mix(cubes.x, cubes.y, random(state)), 1.0 / 3.0);
+
+	gl_Position = (ProjectionMatrix  * ViewMatrix) * vec4(direction * radius, 1.0f);
+
+	// mostly white stars with slight blue or red tint
+	float brightness = mix(0.3, 1.0, random(state));
+	float tint = random(state) * 0.2 - 0.1;
+	pass_Color = brightness * vec3(1.0 - tint, 1.0, 1.0 + tint);
 }